@@ -50,13 +50,19 @@
 #include "cbox/EepromObjectStorage.h"
 #include "cbox/ObjectContainer.h"
 #include "cbox/ObjectFactory.h"
+#include "cbox/TimelineExport.h"
 #include "cbox/Tracing.h"
 #include "cbox/spark/SparkEepromAccess.h"
 #include "deviceid_hal.h"
 #include "platforms.h"
 #include <memory>
 
-using EepromAccessImpl = cbox::SparkEepromAccess;
+#if PLATFORM_ID == 3
+#include "cbox/DataStreamIo.h"
+#include "cbox/posix/MmapEepromAccess.h"
+#include <cstdlib>
+#include <fstream>
+#endif
 
 #if defined(SPARK)
 #include "rgbled.h"
@@ -94,6 +100,9 @@ void updateFirmwareFromStream(cbox::StreamType)
 #include "cbox/spark/ConnectionsSerial.h"
 #endif
 #include "cbox/spark/ConnectionsTcp.h"
+#if PLATFORM_ID == 3
+#include "cbox/posix/ConnectionsUnixSocket.h"
+#endif
 #else
 #include "cbox/ConnectionsStringStream.h"
 
@@ -105,6 +114,11 @@ testConnectionSource()
 }
 #endif
 
+#if defined(COMMS_THREAD)
+#include "cbox/CommandQueue.h"
+#include <thread>
+#endif
+
 #if PLATFORM_ID == 6
 #include "blox/Spark2PinsBlock.h"
 using PinsBlock = Spark2PinsBlock;
@@ -119,12 +133,22 @@ theConnectionPool()
 {
 #if defined(SPARK)
     static cbox::TcpConnectionSource tcpSource(8332);
-#if PLATFORM_ID != 3 || defined(STDIN_SERIAL)
+#if PLATFORM_ID == 3
+    // local tools can connect to the simulator without a TCP port.
+    // The socket path can be set with the BREWBLOX_SOCKET environment variable.
+    const char* socketPath = std::getenv("BREWBLOX_SOCKET");
+    static cbox::UnixSocketConnectionSource socketSource(socketPath ? socketPath : "brewblox.sock");
+#if defined(STDIN_SERIAL)
     static auto& boxSerial = _fetch_usbserial();
     static cbox::SerialConnectionSource serialSource(boxSerial);
-    static cbox::ConnectionPool connections = {tcpSource, serialSource};
+    static cbox::ConnectionPool connections = {tcpSource, socketSource, serialSource};
 #else
-    static cbox::ConnectionPool connections = {tcpSource};
+    static cbox::ConnectionPool connections = {tcpSource, socketSource};
+#endif
+#else
+    static auto& boxSerial = _fetch_usbserial();
+    static cbox::SerialConnectionSource serialSource(boxSerial);
+    static cbox::ConnectionPool connections = {tcpSource, serialSource};
 #endif
 #else
     static cbox::ConnectionPool connections = {testConnectionSource()};
@@ -133,6 +157,42 @@ theConnectionPool()
     return connections;
 }
 
+#if PLATFORM_ID == 3
+// The simulator stores blocks in a memory mapped file instead of the emulated HAL EEPROM.
+// The file can be set with the BREWBLOX_EEPROM_FILE environment variable.
+// If the file cannot be mapped, the HAL EEPROM is used.
+EepromAccess&
+theEeprom()
+{
+    static cbox::SparkEepromAccess halEeprom;
+    const char* path = std::getenv("BREWBLOX_EEPROM_FILE");
+    static cbox::MmapEepromAccess fileEeprom(path ? path : "brewblox-eeprom.bin", 16384);
+    if (!fileEeprom.isMapped()) {
+        return halEeprom;
+    }
+    static bool copied = false;
+    if (fileEeprom.isNew() && !copied) {
+        // copy blocks stored by earlier simulator versions
+        uint8_t buffer[256];
+        for (eeprom_offset_t offset = 0; offset < halEeprom.length(); offset += sizeof(buffer)) {
+            auto size = std::min(eeprom_offset_t(sizeof(buffer)), halEeprom.length() - offset);
+            halEeprom.readBlock(buffer, offset, size);
+            fileEeprom.writeBlock(offset, buffer, size);
+        }
+        fileEeprom.flush();
+        copied = true;
+    }
+    return fileEeprom;
+}
+#else
+EepromAccess&
+theEeprom()
+{
+    static cbox::SparkEepromAccess eeprom;
+    return eeprom;
+}
+#endif
+
 cbox::Box&
 makeBrewBloxBox()
 {
@@ -149,35 +209,33 @@ makeBrewBloxBox()
             cbox::ContainedObject(19, 0x80, std::make_shared<PinsBlock>()),
     });
 
-    static const cbox::ObjectFactory objectFactory{
-        {TempSensorOneWireBlock::staticTypeId(), std::make_shared<TempSensorOneWireBlock>},
-        {SetpointSensorPairBlock::staticTypeId(), []() { return std::make_shared<SetpointSensorPairBlock>(objects); }},
-        {TempSensorMockBlock::staticTypeId(), std::make_shared<TempSensorMockBlock>},
-        {ActuatorAnalogMockBlock::staticTypeId(), []() { return std::make_shared<ActuatorAnalogMockBlock>(objects); }},
-        {PidBlock::staticTypeId(), []() { return std::make_shared<PidBlock>(objects); }},
-        {ActuatorPwmBlock::staticTypeId(), []() { return std::make_shared<ActuatorPwmBlock>(objects); }},
-        {ActuatorOffsetBlock::staticTypeId(), []() { return std::make_shared<ActuatorOffsetBlock>(objects); }},
-        {BalancerBlock::staticTypeId(), std::make_shared<BalancerBlock>},
-        {MutexBlock::staticTypeId(), std::make_shared<MutexBlock>},
-        {SetpointProfileBlock::staticTypeId(), []() { return std::make_shared<SetpointProfileBlock>(objects); }},
-        {DS2413Block::staticTypeId(), std::make_shared<DS2413Block>},
-        {DigitalActuatorBlock::staticTypeId(), []() { return std::make_shared<DigitalActuatorBlock>(objects); }},
-        {DS2408Block::staticTypeId(), std::make_shared<DS2408Block>},
-        {MotorValveBlock::staticTypeId(), []() { return std::make_shared<MotorValveBlock>(objects); }},
-        {ActuatorLogicBlock::staticTypeId(), []() { return std::make_shared<ActuatorLogicBlock>(objects); }},
-        {MockPinsBlock::staticTypeId(), []() { return std::make_shared<MockPinsBlock>(); }},
-        {TempSensorCombiBlock::staticTypeId(), []() { return std::make_shared<TempSensorCombiBlock>(objects); }},
-    };
-
-    static EepromAccessImpl eeprom;
-    static cbox::EepromObjectStorage objectStore(eeprom);
+    using BlockRegistry = cbox::ObjectRegistry<
+        TempSensorOneWireBlock,
+        SetpointSensorPairBlock,
+        TempSensorMockBlock,
+        ActuatorAnalogMockBlock,
+        PidBlock,
+        ActuatorPwmBlock,
+        ActuatorOffsetBlock,
+        BalancerBlock,
+        MutexBlock,
+        SetpointProfileBlock,
+        DS2413Block,
+        DigitalActuatorBlock,
+        DS2408Block,
+        MotorValveBlock,
+        ActuatorLogicBlock,
+        MockPinsBlock,
+        TempSensorCombiBlock>;
+
+    static cbox::EepromObjectStorage objectStore(theEeprom());
     static cbox::ConnectionPool& connections = theConnectionPool();
 
     std::vector<std::unique_ptr<cbox::ScanningFactory>> scanningFactories;
     scanningFactories.reserve(1);
     scanningFactories.push_back(std::make_unique<OneWireScanningFactory>(objects, theOneWire()));
 
-    static cbox::Box box(objectFactory, objects, objectStore, connections, std::move(scanningFactories));
+    static cbox::Box box(BlockRegistry::factory(), objects, objectStore, connections, std::move(scanningFactories));
 
     return box;
 }
@@ -212,50 +270,44 @@ theOneWire()
 }
 #endif
 
+void
+writeLog(Logger::LogLevel level, const char* log, size_t length)
+{
+    const char* prefix = "";
+    switch (level) {
+    case Logger::LogLevel::DEBUG:
+        prefix = "DEBUG:";
+        break;
+    case Logger::LogLevel::INFO:
+        prefix = "INFO:";
+        break;
+    case Logger::LogLevel::WARN:
+        prefix = "WARNING:";
+        break;
+    case Logger::LogLevel::ERROR:
+        prefix = "ERROR:";
+        break;
+    }
+    theConnectionPool().log(prefix, log, length);
+}
+
+uint32_t
+logClock()
+{
+    return ticks.millis();
+}
+
 Logger&
 logger()
 {
-    static Logger logger([](Logger::LogLevel level, const std::string& log) {
-        cbox::DataOut& out = theConnectionPool().logDataOut();
-        out.write('<');
-        const char debug[] = "DEBUG";
-        const char info[] = "INFO";
-        const char warn[] = "WARNING";
-        const char err[] = "ERROR";
-
-        switch (level) {
-        case Logger::LogLevel::DEBUG:
-            out.writeBuffer(debug, strlen(debug));
-            break;
-        case Logger::LogLevel::INFO:
-            out.writeBuffer(info, strlen(info));
-            break;
-        case Logger::LogLevel::WARN:
-            out.writeBuffer(warn, strlen(warn));
-            break;
-        case Logger::LogLevel::ERROR:
-            out.writeBuffer(err, strlen(err));
-            break;
-        }
-        out.write(':');
-        for (const auto& c : log) {
-            out.write(c);
-        }
-        out.write('>');
-    });
+    static Logger logger(writeLog, logClock);
     return logger;
 }
 
 void
 logEvent(const std::string& event)
 {
-    cbox::DataOut& out = theConnectionPool().logDataOut();
-    out.write('<');
-    out.write('!');
-    for (const auto& c : event) {
-        out.write(c);
-    }
-    out.write('>');
+    theConnectionPool().log("!", event.data(), event.size());
 }
 
 void
@@ -267,6 +319,41 @@ updateBrewbloxBox()
 #endif
 }
 
+#if defined(COMMS_THREAD)
+// The queue is never destroyed, because the communication thread uses it until the process exits
+cbox::CommandQueue<>&
+theCommandQueue()
+{
+    static auto queue = new cbox::CommandQueue<>(brewbloxBox(), theConnectionPool());
+    return *queue;
+}
+#endif
+
+void
+startCommunication()
+{
+    brewbloxBox().startConnectionSources();
+#if defined(COMMS_THREAD)
+    theCommandQueue(); // construct before the thread uses it
+    std::thread([]() {
+        while (true) {
+            theCommandQueue().receive();
+            HAL_Delay_Milliseconds(1);
+        }
+    }).detach();
+#endif
+}
+
+void
+communicate()
+{
+#if defined(COMMS_THREAD)
+    theCommandQueue().execute();
+#else
+    brewbloxBox().hexCommunicate();
+#endif
+}
+
 const char*
 versionCsv()
 {
@@ -284,6 +371,47 @@ versionCsv()
     return version;
 }
 
+#if PLATFORM_ID == 3
+const char*
+appTraceName(uint8_t action)
+{
+    switch (action) {
+    case AppTrace::UPDATE_DISPLAY:
+        return "UPDATE_DISPLAY";
+    case AppTrace::SYSTEM_TASKS:
+        return "SYSTEM_TASKS";
+    case AppTrace::MANAGE_CONNECTIVITY:
+        return "MANAGE_CONNECTIVITY";
+    case AppTrace::MDNS_START:
+        return "MDNS_START";
+    case AppTrace::MDNS_PROCESS:
+        return "MDNS_PROCESS";
+    case AppTrace::HTTP_START:
+        return "HTTP_START";
+    case AppTrace::HTTP_STOP:
+        return "HTTP_STOP";
+    case AppTrace::HTTP_RESPONSE:
+        return "HTTP_RESPONSE";
+    case AppTrace::WIFI_CONNECT:
+        return "WIFI_CONNECT";
+    case AppTrace::FIRMWARE_UPDATE_STARTED:
+        return "FIRMWARE_UPDATE_STARTED";
+    }
+    return cbox::tracing::actionName(action);
+}
+
+void
+writeTimelineFile()
+{
+    const char* path = std::getenv("BREWBLOX_TRACE_FILE");
+    std::ofstream file(path ? path : "brewblox-trace.json");
+    if (file) {
+        cbox::OStreamDataOut out(file);
+        cbox::tracing::writeChromeTrace(out, appTraceName);
+    }
+}
+#endif
+
 #if PLATFORM_ID != PLATFORM_GCC
 void
 updateFirmwareStreamHandler(Stream* stream)
@@ -395,11 +523,68 @@ connectionStarted(DataOut& out)
     out.write('>');
 }
 
+uint32_t
+clockMicros()
+{
+    return ticks.micros();
+}
+
 // handler for custom commands outside of controlbox
 bool
 applicationCommand(uint8_t cmdId, cbox::DataIn& in, cbox::EncodedDataOut& out)
 {
     switch (cmdId) {
+    case 101: // read communication statistics
+    case 102: // read and reset communication statistics
+    {
+        CboxError status = CboxError::OK;
+        in.spool();
+        if (out.crc()) {
+            status = CboxError::CRC_ERROR_IN_COMMAND;
+        }
+        out.writeResponseSeparator();
+        out.write(asUint8(status));
+        if (status == CboxError::OK) {
+            brewbloxBox().streamStatsTo(out);
+            if (cmdId == 102) {
+                brewbloxBox().resetStats();
+            }
+        }
+        return true;
+    }
+    case 103: // read the tracing timeline
+    {
+        CboxError status = CboxError::OK;
+        in.spool();
+        if (out.crc()) {
+            status = CboxError::CRC_ERROR_IN_COMMAND;
+        }
+        out.writeResponseSeparator();
+        out.write(asUint8(status));
+        if (status == CboxError::OK) {
+            cbox::tracing::streamTimelineTo(out);
+        }
+        return true;
+    }
+    case 104: // set the enabled trace categories
+    {
+        CboxError status = CboxError::OK;
+        uint8_t mask = 0;
+        if (!in.get(mask)) {
+            status = CboxError::INPUT_STREAM_READ_ERROR;
+        }
+        in.spool();
+        if (out.crc()) {
+            status = CboxError::CRC_ERROR_IN_COMMAND;
+        }
+        out.writeResponseSeparator();
+        out.write(asUint8(status));
+        if (status == CboxError::OK) {
+            cbox::tracing::setCategories(mask);
+            out.write(cbox::tracing::categories());
+        }
+        return true;
+    }
     case 100: // firmware update
     {
         CboxError status = CboxError::OK;
@@ -412,7 +597,7 @@ applicationCommand(uint8_t cmdId, cbox::DataIn& in, cbox::EncodedDataOut& out)
         out.endMessage();
         ticks.delayMillis(10);
         if (status == CboxError::OK) {
-            cbox::tracing::add(AppTrace::FIRMWARE_UPDATE_STARTED);
+            cbox::tracing::add<cbox::tracing::APPLICATION>(AppTrace::FIRMWARE_UPDATE_STARTED);
             changeLedColor();
             brewbloxBox().disconnect();
             ticks.delayMillis(10);
@@ -43,12 +43,26 @@ theOneWire();
 void
 updateBrewbloxBox();
 
+// start accepting connections. With COMMS_THREAD defined (simulator only), connections are processed by a separate thread
+void
+startCommunication();
+
+// handle received commands. With COMMS_THREAD defined, only commands that were queued by the communication thread
+void
+communicate();
+
 const char*
 versionCsv();
 
 void
 logEvent(const std::string& event);
 
+#if PLATFORM_ID == 3
+// write the tracing timeline in Chrome trace format to BREWBLOX_TRACE_FILE (default brewblox-trace.json)
+void
+writeTimelineFile();
+#endif
+
 enum AppTrace : uint8_t {
     UPDATE_DISPLAY = 101,
     SYSTEM_TASKS = 102,
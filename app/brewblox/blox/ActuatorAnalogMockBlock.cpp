@@ -70,15 +70,9 @@ ActuatorAnalogMockBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_ActuatorAnalogMock) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<ActuatorAnalogConstrained>()) {
-        // return the member that implements the interface in this case
-        ActuatorAnalogConstrained* ptr = &constrained;
+    // return the member that implements the interface in this case
+    if (auto ptr = cbox::findInterface<ActuatorAnalogConstrained>(iface, constrained)) {
         return ptr;
     }
-    if (iface == cbox::interfaceId<ProcessValue<ActuatorAnalog::value_t>>()) {
-        // return the member that implements the interface in this case
-        ProcessValue<ActuatorAnalog::value_t>* ptr = &actuator;
-        return ptr;
-    }
-    return nullptr;
+    return cbox::findInterface<ProcessValue<ActuatorAnalog::value_t>>(iface, actuator);
 }
@@ -1,4 +1,5 @@
 #include "ActuatorLogicBlock.h"
+#include <cstring>
 
 blox_Compare_Result
 DigitalCompare::eval() const
@@ -75,7 +76,7 @@ AnalogCompare::write(blox_AnalogCompare& dest, bool includeNotPersisted) const
 cbox::CboxError
 ActuatorLogicBlock::streamFrom(cbox::DataIn& dataIn)
 {
-    blox_ActuatorLogic newData = blox_ActuatorLogic_init_zero;
+    auto& newData = largeMessageBuffer<blox_ActuatorLogic>();
     cbox::CboxError result = streamProtoFrom(dataIn, &newData, blox_ActuatorLogic_fields, blox_ActuatorLogic_size);
     if (result == cbox::CboxError::OK) {
         target.setId(newData.targetId);
@@ -90,7 +91,9 @@ ActuatorLogicBlock::streamFrom(cbox::DataIn& dataIn)
             analogs.emplace_back(newData.analog[i], objectsRef);
         }
 
-        expression = std::string(newData.expression);
+        strncpy(expression.data(), newData.expression, expression.size() - 1);
+        expression.back() = 0;
+        compile();
     }
     return result;
 }
@@ -117,13 +120,13 @@ ActuatorLogicBlock::writeMessage(blox_ActuatorLogic& message, bool includeNotPer
     }
     message.analog_count = analogs.size();
 
-    expression.copy(message.expression, 64);
+    strncpy(message.expression, expression.data(), sizeof(message.expression));
 }
 
 cbox::CboxError
 ActuatorLogicBlock::streamTo(cbox::DataOut& out) const
 {
-    blox_ActuatorLogic message = blox_ActuatorLogic_init_zero;
+    auto& message = largeMessageBuffer<blox_ActuatorLogic>();
     writeMessage(message, true);
 
     return streamProtoTo(out, &message, blox_ActuatorLogic_fields, blox_ActuatorLogic_size);
@@ -132,7 +135,7 @@ ActuatorLogicBlock::streamTo(cbox::DataOut& out) const
 cbox::CboxError
 ActuatorLogicBlock::streamPersistedTo(cbox::DataOut& out) const
 {
-    blox_ActuatorLogic message = blox_ActuatorLogic_init_zero;
+    auto& message = largeMessageBuffer<blox_ActuatorLogic>();
     writeMessage(message, false);
 
     return streamProtoTo(out, &message, blox_ActuatorLogic_fields, blox_ActuatorLogic_size);
@@ -166,108 +169,158 @@ ActuatorLogicBlock::implements(const cbox::obj_type_t& iface)
 blox_Compare_Result
 ActuatorLogicBlock::evaluate()
 {
-    for (auto& d : digitals) {
+    uint32_t values = 0;
+    uint32_t errors = 0;
+    for (uint8_t i = 0; i < digitals.size() && i < maxCompares; i++) {
+        auto& d = digitals[i];
         d.update();
+        values |= uint32_t(d.result() == blox_Compare_Result_RESULT_TRUE) << i;
+        errors |= uint32_t(d.result() > blox_Compare_Result_RESULT_TRUE) << i;
     }
 
-    for (auto& a : analogs) {
+    for (uint8_t i = 0; i < analogs.size() && i < maxCompares; i++) {
+        auto& a = analogs[i];
         a.update();
+        values |= uint32_t(a.result() == blox_Compare_Result_RESULT_TRUE) << (maxCompares + i);
+        errors |= uint32_t(a.result() > blox_Compare_Result_RESULT_TRUE) << (maxCompares + i);
     }
+
+    if (compileResult != blox_Compare_Result_RESULT_TRUE) {
+        m_errorPos = compileErrorPos;
+        return compileResult;
+    }
+
+    if (errors & usedCompares) {
+        // report the first compare in the expression that has an error
+        for (uint8_t pos = 0; expression[pos] != 0; pos++) {
+            auto c = expression[pos];
+            if ('a' <= c && c <= 'z' && (errors & (uint32_t(1) << (c - 'a')))) {
+                m_errorPos = pos;
+                return digitals[c - 'a'].result();
+            }
+            if ('A' <= c && c <= 'Z' && (errors & (uint32_t(1) << (maxCompares + c - 'A')))) {
+                m_errorPos = pos;
+                return analogs[c - 'A'].result();
+            }
+        }
+    }
+
     m_errorPos = 0;
-    if (expression.empty()) {
-        return blox_Compare_Result_RESULT_EMPTY;
+    uint64_t stack = 0; // bit 0 is the top of the stack
+    for (uint8_t i = 0; i < programSize; i++) {
+        auto instruction = program[i];
+        switch (instruction) {
+        case OP_NOT:
+            stack ^= 1;
+            break;
+        case OP_OR:
+            stack = (stack >> 1) | (stack & 1);
+            break;
+        case OP_AND:
+            stack = (stack >> 1) & (stack | ~uint64_t(1));
+            break;
+        case OP_XOR:
+            stack = (stack >> 1) ^ (stack & 1);
+            break;
+        case OP_POP:
+            stack = stack >> 1;
+            break;
+        default:
+            stack = (stack << 1) | ((values >> instruction) & 1);
+            break;
+        }
     }
-    auto it = expression.cbegin();
-    auto result = eval(it, 0);
+    return (stack & 1) ? blox_Compare_Result_RESULT_TRUE : blox_Compare_Result_RESULT_FALSE;
+}
 
-    if (result > blox_Compare_Result_RESULT_TRUE) {
-        m_errorPos = it - expression.cbegin() - 1;
+void
+ActuatorLogicBlock::emit(uint8_t instruction)
+{
+    if (programSize < program.size()) {
+        program[programSize++] = instruction;
+    }
+}
+
+void
+ActuatorLogicBlock::compile()
+{
+    programSize = 0;
+    usedCompares = 0;
+    compileErrorPos = 0;
+    if (expression[0] == 0) {
+        compileResult = blox_Compare_Result_RESULT_EMPTY;
+        return;
+    }
+    const char* it = expression.data();
+    compileResult = compile(it, 0);
+
+    if (compileResult > blox_Compare_Result_RESULT_TRUE) {
+        compileErrorPos = it - expression.data() - 1;
     }
-    return result;
 }
 
+// Returns RESULT_TRUE when the sub expression pushes a value, RESULT_EMPTY_SUBSTRING when it pushes nothing, or the syntax error
 blox_Compare_Result
-ActuatorLogicBlock::eval(std::string::const_iterator& it, uint8_t level) const
+ActuatorLogicBlock::compile(const char*& it, uint8_t level)
 {
     blox_Compare_Result res = blox_Compare_Result_RESULT_EMPTY_SUBSTRING;
-    while (it < expression.cend()) {
-        if (res > blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-            return res;
-        }
+    while (*it != 0) {
         auto c = *it;
         ++it;
         if ('a' <= c && c <= 'z') {
             if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_COMPARISON;
             }
-            auto compare = digitals.cbegin() + (c - 'a');
-            if (compare >= digitals.cend()) {
+            uint8_t index = c - 'a';
+            if (index >= digitals.size() || index >= maxCompares) {
                 return blox_Compare_Result_RESULT_UNDEFINED_DIGITAL_COMPARE;
             }
-            res = compare->result();
+            emit(index);
+            usedCompares |= uint32_t(1) << index;
+            res = blox_Compare_Result_RESULT_TRUE;
         } else if ('A' <= c && c <= 'Z') {
             if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_COMPARISON;
             }
-            auto compare = analogs.cbegin() + (c - 'A');
-            if (compare >= analogs.cend()) {
+            uint8_t index = c - 'A';
+            if (index >= analogs.size() || index >= maxCompares) {
                 return blox_Compare_Result_RESULT_UNDEFINED_ANALOG_COMPARE;
             }
-            res = compare->result();
+            emit(maxCompares + index);
+            usedCompares |= uint32_t(1) << (maxCompares + index);
+            res = blox_Compare_Result_RESULT_TRUE;
         } else if (c == '!') {
-            auto rhs = eval(it, level);
-            if (rhs > blox_Compare_Result_RESULT_TRUE) {
-                return rhs; // error
+            if (res == blox_Compare_Result_RESULT_TRUE) {
+                emit(OP_POP); // the value before the inversion is not used
             }
+            auto rhs = compile(it, level);
             if (rhs == blox_Compare_Result_RESULT_TRUE) {
-                return blox_Compare_Result_RESULT_FALSE;
-            }
-            return blox_Compare_Result_RESULT_TRUE;
-        } else if (c == '|') {
-            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-                return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
-            }
-            auto rhs = eval(it, level);
-            if (rhs > blox_Compare_Result_RESULT_TRUE) {
-                return rhs; // error
-            }
-            if (res == blox_Compare_Result_RESULT_TRUE) {
-                return res;
+                emit(OP_NOT);
             }
             return rhs;
-        } else if (c == '&') {
+        } else if (c == '|' || c == '&' || c == '^') {
             if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
             }
-            auto rhs = eval(it, level);
-            if (rhs > blox_Compare_Result_RESULT_TRUE) {
-                return rhs; // error
+            auto rhs = compile(it, level);
+            if (rhs == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
+                emit(OP_POP); // the expression is empty, drop the left hand side
             }
-            if (res == blox_Compare_Result_RESULT_TRUE) {
-                return rhs;
+            if (rhs != blox_Compare_Result_RESULT_TRUE) {
+                return rhs; // error or empty
             }
-            return res;
-        } else if (c == '^') {
-            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-                return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
-            }
-            auto rhs = eval(it, level);
-            if (rhs != blox_Compare_Result_RESULT_TRUE && rhs != blox_Compare_Result_RESULT_FALSE) {
-                return rhs; // error
-            }
-            if (rhs != res) {
-                return blox_Compare_Result_RESULT_TRUE;
-            }
-            return blox_Compare_Result_RESULT_FALSE;
+            emit(c == '|' ? OP_OR : c == '&' ? OP_AND : OP_XOR);
+            return rhs;
         } else if (c == '(') {
-            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-                res = eval(it, level + 1);
-            } else {
+            if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_OPEN_BRACKET;
             }
+            res = compile(it, level + 1);
+            if (res > blox_Compare_Result_RESULT_EMPTY_SUBSTRING && *it != 0) {
+                return res; // error
+            }
         } else if (c == ')') {
             if (level == 0) {
-                // first check is to not overwrite earlier error
                 return blox_Compare_Result_RESULT_UNEXPECTED_CLOSE_BRACKET;
             }
             return res;
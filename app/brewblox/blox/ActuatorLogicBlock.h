@@ -7,6 +7,7 @@
 #include "blox/Block.h"
 #include "cbox/CboxPtr.h"
 #include "proto/cpp/ActuatorLogic.pb.h"
+#include <array>
 #include <vector>
 
 namespace cbox {
@@ -84,10 +85,28 @@ private:
     bool enabled = false;
     std::vector<DigitalCompare> digitals;
     std::vector<AnalogCompare> analogs;
-    std::string expression;
+    std::array<char, sizeof(blox_ActuatorLogic::expression)> expression{}; // zero terminated
     blox_Compare_Result m_result = blox_Compare_Result_RESULT_FALSE;
     uint8_t m_errorPos = 0;
 
+    // The expression is compiled to a postfix program when it is received.
+    // Values below OP_NOT load the result of a compare: digital compares are 0-15, analog compares 16-31.
+    // The program operates on a stack of bits, so evaluating it is a single loop without recursion.
+    enum Instruction : uint8_t {
+        OP_NOT = 32,
+        OP_OR,
+        OP_AND,
+        OP_XOR,
+        OP_POP,
+    };
+    static constexpr uint8_t maxCompares = 16;
+    // each character emits at most 2 instructions: a '!' after a value drops that value and inverts what follows
+    std::array<uint8_t, 2 * sizeof(blox_ActuatorLogic::expression)> program{};
+    uint8_t programSize = 0;
+    uint32_t usedCompares = 0;                                            // bit mask of compares that are loaded by the program
+    blox_Compare_Result compileResult = blox_Compare_Result_RESULT_EMPTY; // RESULT_TRUE when the program is valid
+    uint8_t compileErrorPos = 0;
+
 public:
     ActuatorLogicBlock(cbox::ObjectContainer& objects)
         : objectsRef(objects)
@@ -109,6 +128,8 @@ public:
     blox_Compare_Result evaluate();
 
 private:
-    blox_Compare_Result eval(std::string::const_iterator& it, uint8_t level) const;
+    void compile();
+    blox_Compare_Result compile(const char*& it, uint8_t level);
+    void emit(uint8_t instruction);
     void writeMessage(blox_ActuatorLogic& message, bool includeNotPersisted) const;
 };
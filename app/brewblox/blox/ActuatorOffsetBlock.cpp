@@ -83,10 +83,6 @@ ActuatorOffsetBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_ActuatorOffset) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<ActuatorAnalogConstrained>()) {
-        // return the member that implements the interface in this case
-        ActuatorAnalogConstrained* ptr = &constrained;
-        return ptr;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<ActuatorAnalogConstrained>(iface, constrained);
 }
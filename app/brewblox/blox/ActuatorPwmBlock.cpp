@@ -91,15 +91,6 @@ ActuatorPwmBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_ActuatorPwm) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<ActuatorAnalogConstrained>()) {
-        // return the member that implements the interface in this case
-        ActuatorAnalogConstrained* ptr = &constrained;
-        return ptr;
-    }
-    if (iface == cbox::interfaceId<ProcessValue<ActuatorAnalog::value_t>>()) {
-        // return the member that implements the interface in this case
-        ProcessValue<ActuatorAnalog::value_t>* ptr = &constrained;
-        return ptr;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<ActuatorAnalogConstrained, ProcessValue<ActuatorAnalog::value_t>>(iface, constrained);
 }
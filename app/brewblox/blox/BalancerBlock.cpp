@@ -39,10 +39,6 @@ BalancerBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_Balancer) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<Balancer_t>()) {
-        // return the member that implements the interface in this case
-        Balancer_t* ptr = &balancer;
-        return ptr;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<Balancer_t>(iface, balancer);
 }
@@ -8,9 +8,83 @@
 #include "blox/Block.h"
 #include "cbox/DataStream.h"
 #include "nanopb_callbacks.h"
+#include "proto/cpp/ActuatorLogic.pb.h"
+#include "proto/cpp/DisplaySettings.pb.h"
+#include <cstring>
+
+namespace {
+union LargeMessage {
+    blox_ActuatorLogic actuatorLogic;
+    blox_DisplaySettings displaySettings;
+};
+
+LargeMessage largeMessage;
+
+// shared like largeMessage, messages are only encoded by the control thread
+pb_byte_t encodeBuffer[protoEncodeBufferSize()];
+
+// true if the message or one of its sub messages has a field that is encoded by a callback
+bool
+hasCallbackFields(const pb_field_t fields[])
+{
+    for (const pb_field_t* field = fields; field->tag != 0; ++field) {
+        if (PB_ATYPE(field->type) == PB_ATYPE_CALLBACK) {
+            return true;
+        }
+        if (PB_LTYPE(field->type) == PB_LTYPE_SUBMESSAGE && hasCallbackFields(static_cast<const pb_field_t*>(field->ptr))) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+template <>
+blox_ActuatorLogic&
+largeMessageBuffer<blox_ActuatorLogic>()
+{
+    memset(&largeMessage, 0, sizeof(largeMessage)); // same as init_zero, without a temporary on the stack
+    return largeMessage.actuatorLogic;
+}
+
+template <>
+blox_DisplaySettings&
+largeMessageBuffer<blox_DisplaySettings>()
+{
+    memset(&largeMessage, 0, sizeof(largeMessage));
+    return largeMessage.displaySettings;
+}
 
 cbox::CboxError
 streamProtoTo(cbox::DataOut& out, const void* srcStruct, const pb_field_t fields[], size_t maxSize)
+{
+    size_t encodedSize = maxSize;
+    if (maxSize >= protoEncodeBufferSize()) {
+        if (hasCallbackFields(fields)) {
+            // getting the size would run the callbacks, which can be expensive or produce a different size the second time
+            return streamProtoToCallback(out, srcStruct, fields, maxSize);
+        }
+        // the message might not fit in the buffer, get the actual size
+        if (!pb_get_encoded_size(&encodedSize, fields, srcStruct)) {
+            return cbox::CboxError::OUTPUT_STREAM_ENCODING_ERROR;
+        }
+    }
+
+    if (encodedSize < protoEncodeBufferSize()) {
+        // encode into the buffer and write it in one call, instead of writing each field separately
+        pb_ostream_t stream = pb_ostream_from_buffer(encodeBuffer, encodedSize);
+        if (!pb_encode(&stream, fields, srcStruct)) {
+            return cbox::CboxError::OUTPUT_STREAM_ENCODING_ERROR;
+        }
+        encodeBuffer[stream.bytes_written] = 0; // zero terminate every write, so protobuf will stop processing on encountering this zero field tag
+        return out.writeBuffer(encodeBuffer, stream.bytes_written + 1) ? cbox::CboxError::OK : cbox::CboxError::OUTPUT_STREAM_WRITE_ERROR;
+    }
+
+    return streamProtoToCallback(out, srcStruct, fields, maxSize);
+}
+
+cbox::CboxError
+streamProtoToCallback(cbox::DataOut& out, const void* srcStruct, const pb_field_t fields[], size_t maxSize)
 {
     pb_ostream_t stream = {dataOutStreamCallback, &out, maxSize, 0};
     bool success = pb_encode(&stream, fields, srcStruct);
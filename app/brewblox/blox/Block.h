@@ -8,8 +8,31 @@
 template <uint16_t id>
 using Block = cbox::ObjectBase<id>;
 
+// messages smaller than this are encoded into a static buffer and written to the stream in one call
+#ifndef PROTO_ENCODE_BUFFER_SIZE
+#define PROTO_ENCODE_BUFFER_SIZE 256
+#endif
+
+constexpr size_t
+protoEncodeBufferSize()
+{
+    return PROTO_ENCODE_BUFFER_SIZE;
+}
+
+/**
+ * Messages that are too large to decode or encode on the stack use this buffer, which is shared by all blocks.
+ * Blocks are only streamed from the control thread, one at a time, so the buffer is never in use twice.
+ * The returned message is zero initialized. Only defined for the large message types listed in Block.cpp.
+ */
+template <typename T>
+T&
+largeMessageBuffer();
+
 // helpers functions to stream protobuf fields
 cbox::CboxError
 streamProtoTo(cbox::DataOut& out, const void* srcStruct, const pb_field_t fields[], size_t maxSize);
+// encodes the message field by field to the stream, used for messages with callbacks or that don't fit in the encode buffer
+cbox::CboxError
+streamProtoToCallback(cbox::DataOut& out, const void* srcStruct, const pb_field_t fields[], size_t maxSize);
 cbox::CboxError
 streamProtoFrom(cbox::DataIn& in, void* destStruct, const pb_field_t fields[], size_t maxSize);
@@ -86,20 +86,6 @@ DS2408Block::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_DS2408) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<IoArray>()) {
-        // return the member that implements the interface in this case
-        IoArray* ptr = &device;
-        return ptr;
-    }
-    if (iface == cbox::interfaceId<DS2408>()) {
-        // return the member that implements the interface in this case
-        return &device;
-    }
-    if (iface == cbox::interfaceId<OneWireDevice>()) {
-        // return the member that implements the interface in this case
-        DS2408* dsPtr = &device;
-        OneWireDevice* devicePtr = dsPtr;
-        return devicePtr;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<IoArray, DS2408, OneWireDevice>(iface, device);
 }
@@ -72,16 +72,6 @@ DS2413Block::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_DS2413) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<IoArray>()) {
-        // return the member that implements the interface in this case
-        IoArray* ptr = &device;
-        return ptr;
-    }
-    if (iface == cbox::interfaceId<OneWireDevice>()) {
-        // return the member that implements the interface in this case
-        DS2413* dsPtr = &device;
-        OneWireDevice* devicePtr = dsPtr;
-        return devicePtr;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<IoArray, OneWireDevice>(iface, device);
 }
@@ -29,7 +29,7 @@ DisplaySettingsBlock::streamTo(cbox::DataOut& out) const
 cbox::CboxError
 DisplaySettingsBlock::streamFrom(cbox::DataIn& in)
 {
-    blox_DisplaySettings msg = blox_DisplaySettings_init_zero;
+    auto& msg = largeMessageBuffer<blox_DisplaySettings>();
     cbox::CboxError result = streamProtoFrom(in, &msg, blox_DisplaySettings_fields, blox_DisplaySettings_size);
 
     if (result == cbox::CboxError::OK) {
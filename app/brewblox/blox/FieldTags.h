@@ -2,33 +2,33 @@
 
 #include "cbox/DataStream.h"
 #include "nanopb_callbacks.h"
-#include <vector>
+#include <array>
 
+// Tags of fields that are stripped from a message. Stored in a fixed array, so streaming a block does not allocate.
 class FieldTags {
 private:
-    std::vector<uint16_t> m_tags;
+    std::array<uint16_t, 8> m_tags;
+    pb_size_t m_count = 0;
 
 public:
     FieldTags() {}
 
     ~FieldTags() = default;
 
-    void add(uint16_t&& t)
+    // tags that do not fit are ignored, no message strips more than the capacity
+    void add(uint16_t t)
     {
-        m_tags.push_back(t);
+        if (m_count < m_tags.size()) {
+            m_tags[m_count++] = t;
+        }
     }
 
-    void copyToMessage(uint16_t* dest, pb_size_t& count, const pb_size_t& maxCount)
+    void copyToMessage(uint16_t* dest, pb_size_t& count, const pb_size_t& maxCount) const
     {
         count = 0;
-        for (auto it = m_tags.cbegin(); it != m_tags.cend() && it < m_tags.cbegin() + maxCount; ++it) {
-            *(dest++) = *it;
+        for (pb_size_t i = 0; i < m_count && i < maxCount; ++i) {
+            *(dest++) = m_tags[i];
             ++count;
         }
     }
-
-    const std::vector<uint16_t>& tags()
-    {
-        return m_tags;
-    }
 };
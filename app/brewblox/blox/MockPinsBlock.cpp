@@ -52,9 +52,6 @@ MockPinsBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_MockPins) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<IoArray>()) {
-        // return the member that implements the interface in this case
-        return &mocks;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<IoArray>(iface, mocks);
 }
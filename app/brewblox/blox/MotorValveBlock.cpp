@@ -95,10 +95,6 @@ MotorValveBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_MotorValve) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<ActuatorDigitalConstrained>()) {
-        // return the member that implements the interface in this case
-        ActuatorDigitalConstrained* ptr = &constrained;
-        return ptr;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<ActuatorDigitalConstrained>(iface, constrained);
 }
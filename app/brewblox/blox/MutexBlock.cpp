@@ -48,10 +48,6 @@ MutexBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_Mutex) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<MutexTarget>()) {
-        // return the member that implements the interface in this case
-        MutexTarget* ptr = &m_mutex;
-        return ptr;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<MutexTarget>(iface, m_mutex);
 }
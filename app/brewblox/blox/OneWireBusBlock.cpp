@@ -85,7 +85,8 @@ OneWireBusBlock::streamTo(cbox::DataOut& out) const
     // commands are one-shot - once the command is done clear it.
     command.opcode = NO_OP;
     command.data = 0;
-    return streamProtoTo(out, &message, blox_OneWireBus_fields, std::numeric_limits<size_t>::max());
+    // the search can only run once, so the message cannot be encoded twice to get its size first
+    return streamProtoToCallback(out, &message, blox_OneWireBus_fields, std::numeric_limits<size_t>::max());
 }
 
 /**
@@ -96,24 +96,26 @@ PidBlock::streamTo(cbox::DataOut& out) const
         stripped.add(blox_Pid_outputSetting_tag);
         stripped.add(blox_Pid_outputValue_tag);
     }
-    if (pid.active()) {
+    // runtime fields are read from the snapshot published by the last update, so they are consistent with each other
+    auto state = pid.state();
+    if (state.active) {
         message.drivenOutputId = message.outputId;
     }
 
     message.enabled = pid.enabled();
-    message.active = pid.active();
+    message.active = state.active;
     message.kp = cnl::unwrap(pid.kp());
     message.ti = pid.ti();
     message.td = pid.td();
-    message.p = cnl::unwrap(pid.p());
-    message.i = cnl::unwrap(pid.i());
-    message.d = cnl::unwrap(pid.d());
-    message.error = cnl::unwrap(pid.error());
-    message.integral = cnl::unwrap(pid.integral());
-    message.derivative = cnl::unwrap(pid.derivative());
+    message.p = cnl::unwrap(state.p);
+    message.i = cnl::unwrap(state.i);
+    message.d = cnl::unwrap(state.d);
+    message.error = cnl::unwrap(state.error);
+    message.integral = cnl::unwrap(state.integral);
+    message.derivative = cnl::unwrap(state.derivative);
     message.boilPointAdjust = cnl::unwrap(pid.boilPointAdjust());
     message.boilMinOutput = cnl::unwrap(pid.boilMinOutput());
-    message.boilModeActive = pid.boilModeActive();
+    message.boilModeActive = state.boilModeActive;
     message.derivativeFilter = blox_FilterChoice(pid.derivativeFilterNr());
 
     stripped.copyToMessage(message.strippedFields, message.strippedFields_count, 4);
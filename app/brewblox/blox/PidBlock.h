@@ -24,6 +24,7 @@
 #include "Pid.h"
 #include "blox/Block.h"
 #include "cbox/CboxPtr.h"
+#include <algorithm>
 
 class PidBlock : public Block<BrewBloxTypes_BlockType_Pid> {
 private:
@@ -31,7 +32,7 @@ private:
     cbox::CboxPtr<ActuatorAnalogConstrained> output;
 
     Pid pid;
-    IntervalHelper<1000> m_intervalHelper;
+    IntervalHelper m_intervalHelper;
     bool previousActive = false;
 
 public:
@@ -61,6 +62,21 @@ public:
         return pid;
     }
 
+    duration_millis_t
+    updateInterval() const
+    {
+        return m_intervalHelper.interval();
+    }
+
+    // the integral and derivative are scaled to the interval, so the pid settings do not depend on it
+    void
+    updateInterval(duration_millis_t v)
+    {
+        v = std::max(v, duration_millis_t(10));
+        m_intervalHelper.interval(v);
+        pid.updateInterval(v);
+    }
+
     const auto&
     getInputLookup() const
     {
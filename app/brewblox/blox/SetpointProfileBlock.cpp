@@ -26,8 +26,10 @@
 bool
 streamPointsOut(pb_ostream_t* stream, const pb_field_t* field, void* const* arg)
 {
-    const std::vector<SetpointProfileBlock::Point>* points = reinterpret_cast<std::vector<SetpointProfileBlock::Point>*>(*arg);
-    for (const auto& p : *points) {
+    const ProfilePoints* points = reinterpret_cast<const ProfilePoints*>(*arg);
+    auto reader = points->reader();
+    SetpointProfileBlock::Point p;
+    while (reader.next(p)) {
         auto submsg = blox_Point();
         submsg.time = p.time;
         submsg.temperature_oneof.temperature = cnl::unwrap(p.temp);
@@ -45,7 +47,7 @@ streamPointsOut(pb_ostream_t* stream, const pb_field_t* field, void* const* arg)
 bool
 streamPointsIn(pb_istream_t* stream, const pb_field_t*, void** arg)
 {
-    std::vector<SetpointProfileBlock::Point>* newPoints = reinterpret_cast<std::vector<SetpointProfileBlock::Point>*>(*arg);
+    ProfilePoints* newPoints = reinterpret_cast<ProfilePoints*>(*arg);
 
     if (stream->bytes_left) {
         blox_Point submsg = blox_Point_init_zero;
@@ -61,7 +63,7 @@ cbox::CboxError
 SetpointProfileBlock::streamFrom(cbox::DataIn& in)
 {
     blox_SetpointProfile newData = blox_SetpointProfile_init_zero;
-    std::vector<Point> newPoints;
+    ProfilePoints newPoints;
     newData.points.funcs.decode = &streamPointsIn;
     newData.points.arg = &newPoints;
     cbox::CboxError result = streamProtoFrom(in, &newData, blox_SetpointProfile_fields, std::numeric_limits<size_t>::max() - 1);
@@ -80,7 +82,7 @@ SetpointProfileBlock::streamTo(cbox::DataOut& out) const
     blox_SetpointProfile message = blox_SetpointProfile_init_zero;
     FieldTags stripped;
     message.points.funcs.encode = &streamPointsOut;
-    message.points.arg = const_cast<std::vector<Point>*>(&profile.points());
+    message.points.arg = const_cast<ProfilePoints*>(&profile.points());
     message.enabled = profile.enabled();
     message.start = profile.startTime();
     message.targetId = target.getId();
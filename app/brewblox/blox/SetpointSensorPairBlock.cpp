@@ -33,11 +33,13 @@ SetpointSensorPairBlock::streamFrom(cbox::DataIn& in)
         pair.filterChoice(uint8_t(newData.filter));
         pair.filterThreshold(cnl::wrap<fp12_t>(newData.filterThreshold));
 
-        if (newData.resetFilter || sensor.getId() != newData.sensorId) {
+        if (sensor.getId() != newData.sensorId) {
             sensor.setId(newData.sensorId);
+        }
+        pair.updateSensor(); // use the new sensor right away, without adding a sample outside of the update interval
+        if (newData.resetFilter) {
             pair.resetFilter();
         }
-        pair.update(); // force an update that bypasses the update interval
     }
     return res;
 }
@@ -105,14 +107,6 @@ SetpointSensorPairBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_SetpointSensorPair) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<ProcessValue<temp_t>>()) {
-        // return the member that implements the interface in this case
-        ProcessValue<temp_t>* ptr = &pair;
-        return ptr;
-    }
-    if (iface == cbox::interfaceId<SetpointSensorPair>()) {
-        SetpointSensorPair* ptr = &pair;
-        return ptr;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<ProcessValue<temp_t>, SetpointSensorPair>(iface, pair);
 }
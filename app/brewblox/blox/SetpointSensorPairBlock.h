@@ -21,12 +21,13 @@
 #include "SetpointSensorPair.h"
 #include "blox/Block.h"
 #include "cbox/CboxPtr.h"
+#include <algorithm>
 
 class SetpointSensorPairBlock : public Block<BrewBloxTypes_BlockType_SetpointSensorPair> {
 private:
     cbox::CboxPtr<TempSensor> sensor;
     SetpointSensorPair pair;
-    IntervalHelper<1000> m_intervalHelper;
+    IntervalHelper m_intervalHelper;
 
 public:
     SetpointSensorPairBlock(cbox::ObjectContainer& objects)
@@ -56,4 +57,17 @@ public:
     {
         return pair;
     }
+
+    duration_millis_t updateInterval() const
+    {
+        return m_intervalHelper.interval();
+    }
+
+    // the filters add a sample per update, the derivative is scaled to the interval
+    void updateInterval(duration_millis_t v)
+    {
+        v = std::max(v, duration_millis_t(10));
+        m_intervalHelper.interval(v);
+        pair.sampleInterval(v);
+    }
 };
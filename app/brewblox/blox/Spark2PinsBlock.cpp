@@ -110,12 +110,8 @@ Spark2PinsBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_Spark2Pins) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<IoArray>()) {
-        // return the member that implements the interface in this case
-        IoArray* ptr = this;
-        return ptr;
-    }
-    return nullptr;
+    // the block implements the interface itself
+    return cbox::findInterface<IoArray>(iface, *this);
 }
 
 #endif
\ No newline at end of file
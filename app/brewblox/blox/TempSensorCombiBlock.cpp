@@ -92,10 +92,6 @@ TempSensorCombiBlock::implements(const cbox::obj_type_t& iface)
     if (iface == BrewBloxTypes_BlockType_TempSensorCombi) {
         return this; // me!
     }
-    if (iface == cbox::interfaceId<TempSensor>()) {
-        // return the member that implements the interface in this case
-        TempSensor* ptr = &sensor;
-        return ptr;
-    }
-    return nullptr;
+    // return the member that implements the interface in this case
+    return cbox::findInterface<TempSensor>(iface, sensor);
 }
\ No newline at end of file
@@ -109,12 +109,8 @@ public:
         if (iface == BrewBloxTypes_BlockType_TempSensorMock) {
             return this; // me!
         }
-        if (iface == cbox::interfaceId<TempSensor>()) {
-            // return the member that implements the interface in this case
-            TempSensor* ptr = &sensor;
-            return ptr;
-        }
-        return nullptr;
+        // return the member that implements the interface in this case
+        return cbox::findInterface<TempSensor>(iface, sensor);
     }
 
     TempSensorMock& get()
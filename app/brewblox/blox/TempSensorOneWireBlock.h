@@ -68,19 +68,8 @@ public:
         if (iface == BrewBloxTypes_BlockType_TempSensorOneWire) {
             return this; // me!
         }
-        if (iface == cbox::interfaceId<TempSensor>()) {
-            // return the member that implements the interface in this case
-            DS18B20* owptr = &sensor;
-            TempSensor* ptr = owptr;
-            return ptr;
-        }
-        if (iface == cbox::interfaceId<OneWireDevice>()) {
-            // return the member that implements the interface in this case
-            DS18B20* sensorPtr = &sensor;
-            OneWireDevice* devicePtr = sensorPtr;
-            return devicePtr;
-        }
-        return nullptr;
+        // return the member that implements the interface in this case
+        return cbox::findInterface<TempSensor, OneWireDevice>(iface, sensor);
     }
 
     DS18B20& get()
@@ -118,6 +118,16 @@ endif
 # CPPFLAGS += -Wsuggest-final-types
 # CPPFLAGS += -Wsuggest-final-methods
 
+# process connections on a separate thread, commands are executed by the main loop
+# only supported by the simulator (gcc platform), it uses std::thread which is not available on the photon and P1
+ifeq ("$(COMMS_THREAD)","y")
+ifeq ($(PLATFORM_ID),3)
+CFLAGS += -DCOMMS_THREAD
+else
+$(error COMMS_THREAD=y is only supported when building for PLATFORM=gcc)
+endif
+endif
+
 ifeq ($(PLATFORM_ID),3)
 ifeq ("$(TEST_BUILD)","y") # coverage, address sanitizer, undefined behavior
 include $(SOURCE_PATH)/build/checkers.mk # sanitizer and gcov
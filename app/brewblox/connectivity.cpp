@@ -153,7 +153,7 @@ manageConnections(uint32_t now)
     static uint32_t lastConnected = 0;
     static uint32_t lastChecked = 0;
     static uint32_t lastAnnounce = 0;
-    cbox::tracing::add(AppTrace::MANAGE_CONNECTIVITY);
+    cbox::tracing::Scope<cbox::tracing::APPLICATION> traceConnectivity(AppTrace::MANAGE_CONNECTIVITY);
     if (now - lastChecked >= 1000) {
         updateWifiSignal();
         lastChecked = now;
@@ -161,25 +161,25 @@ manageConnections(uint32_t now)
     if (wifiConnected()) {
         lastConnected = now;
         if ((!mdns_started) || ((now - lastAnnounce) > 300000)) {
-            cbox::tracing::add(AppTrace::MDNS_START);
+            cbox::tracing::Scope<cbox::tracing::APPLICATION> trace(AppTrace::MDNS_START);
             // explicit announce every 5 minutes
             mdns_started = theMdns().begin(true);
             lastAnnounce = now;
         }
         if (!http_started) {
-            cbox::tracing::add(AppTrace::HTTP_START);
+            cbox::tracing::Scope<cbox::tracing::APPLICATION> trace(AppTrace::HTTP_START);
             http_started = httpserver.begin();
         }
 
         if (mdns_started) {
-            cbox::tracing::add(AppTrace::MDNS_PROCESS);
+            cbox::tracing::Scope<cbox::tracing::APPLICATION> trace(AppTrace::MDNS_PROCESS);
             theMdns().processQueries();
         }
         if (http_started) {
             while (true) {
                 TCPClient client = httpserver.available();
                 if (client) {
-                    cbox::tracing::add(AppTrace::HTTP_RESPONSE);
+                    cbox::tracing::Scope<cbox::tracing::APPLICATION> trace(AppTrace::HTTP_RESPONSE);
                     const uint8_t start[] =
                         "HTTP/1.1 200 Ok\n\n<html><body>"
                         "<p>Your BrewBlox Spark is online but it does not run its own web server. "
@@ -207,7 +207,7 @@ manageConnections(uint32_t now)
         if (now - lastConnected > 60000) {
             // after 60 seconds without WiFi, trigger reconnect
             // wifi is expected to reconnect automatically. This is a failsafe in case it does not
-            cbox::tracing::add(AppTrace::WIFI_CONNECT);
+            cbox::tracing::Scope<cbox::tracing::APPLICATION> trace(AppTrace::WIFI_CONNECT);
             if (!spark::WiFi.connecting()) {
                 spark::WiFi.connect(WIFI_CONNECT_SKIP_LISTEN);
             }
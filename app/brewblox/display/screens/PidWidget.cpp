@@ -123,11 +123,11 @@ PidWidget::drawPidRect(const fp12_t& v, D4D_COOR yPos)
 }
 
 void
-PidWidget::drawPidRects(const Pid& pid)
+PidWidget::drawPidRects(const Pid::State& state)
 {
-    drawPidRect(pid.p(), 54);
-    drawPidRect(pid.i(), 58);
-    drawPidRect(pid.d(), 62);
+    drawPidRect(state.p, 54);
+    drawPidRect(state.i, 58);
+    drawPidRect(state.d, 62);
 }
 
 void
@@ -162,7 +162,7 @@ PidWidget::update(const WidgetSettings& settings)
             setAndEnable(&outputTarget, "");
         }
 
-        drawPidRects(pid);
+        drawPidRects(pid.state());
 
         char icons[2] = "\x28";
         if (auto pwmBlock = outputLookup.const_lock_as<ActuatorPwmBlock>()) {
@@ -100,5 +100,5 @@ public:
 
 private:
     void drawPidRect(const fp12_t& v, D4D_COOR yPos);
-    void drawPidRects(const Pid& pid);
+    void drawPidRects(const Pid::State& state);
 };
\ No newline at end of file
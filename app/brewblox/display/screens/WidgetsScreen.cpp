@@ -102,7 +102,7 @@ WidgetsScreen::loadSettings()
     pb_size_t numWidgets = std::min(settings.widgets_count, pb_size_t(sizeof(settings.widgets) / sizeof(settings.widgets[0])));
     widgets.resize(numWidgets);
     for (pb_size_t i = 0; i < numWidgets; ++i) {
-        blox_Widget widgetDfn = settings.widgets[i];
+        const blox_Widget& widgetDfn = settings.widgets[i];
         auto pos = widgetDfn.pos;
         if (pos == 0 || pos > 6) {
             continue; // invalid position on screen
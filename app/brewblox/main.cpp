@@ -52,6 +52,24 @@ signal_handler(int signal)
 
     exit(signal);
 }
+
+// SIGUSR1 requests the tracing timeline to be written to a file, which is done from the main loop
+static volatile std::sig_atomic_t timelineExportRequested = 0;
+
+void
+requestTimelineExport(int)
+{
+    timelineExportRequested = 1;
+}
+
+void
+exportTimelineIfRequested()
+{
+    if (timelineExportRequested) {
+        timelineExportRequested = 0;
+        writeTimelineFile();
+    }
+}
 #endif
 
 void
@@ -120,6 +138,7 @@ setup()
 #if PLATFORM_ID == PLATFORM_GCC
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
+    std::signal(SIGUSR1, requestTimelineExport);
     // pin map is not initialized properly in gcc build before setup runs
     boardInit();
     manageConnections(0); // init network early to websocket display emulation works during setup()
@@ -184,7 +203,7 @@ setup()
     System.on(out_of_memory, onOutOfMemory);
 #endif
 
-    brewbloxBox().startConnectionSources();
+    startCommunication();
     WidgetsScreen::activate();
 }
 
@@ -192,12 +211,14 @@ void
 loop()
 {
     ticks.switchTaskTimer(TicksClass::TaskId::DisplayUpdate);
-    cbox::tracing::add(AppTrace::UPDATE_DISPLAY);
-    displayTick();
+    {
+        cbox::tracing::Scope<cbox::tracing::APPLICATION> trace(AppTrace::UPDATE_DISPLAY);
+        displayTick();
+    }
     if (!listeningModeEnabled()) {
         ticks.switchTaskTimer(TicksClass::TaskId::Communication);
         manageConnections(ticks.millis());
-        brewbloxBox().hexCommunicate();
+        communicate();
 
         ticks.switchTaskTimer(TicksClass::TaskId::BlocksUpdate);
         updateBrewbloxBox();
@@ -205,8 +226,13 @@ loop()
         watchdogCheckin(); // not done while listening, so 60s timeout for stuck listening mode
     }
     ticks.switchTaskTimer(TicksClass::TaskId::System);
-    cbox::tracing::add(AppTrace::SYSTEM_TASKS);
-    HAL_Delay_Milliseconds(1);
+    {
+        cbox::tracing::Scope<cbox::tracing::APPLICATION> trace(AppTrace::SYSTEM_TASKS);
+        HAL_Delay_Milliseconds(1);
+    }
+#if PLATFORM_ID == PLATFORM_GCC
+    exportTimelineIfRequested();
+#endif
 }
 
 void
@@ -19,6 +19,7 @@
 
 #include <catch.hpp>
 
+#include "AllocationCounter.h"
 #include "BrewBloxTestBox.h"
 #include "blox/ActuatorLogicBlock.h"
 #include "blox/DigitalActuatorBlock.h"
@@ -191,6 +192,17 @@ SCENARIO("Test", "[maklogicblock]")
                 CHECK(decoded.ShortDebugString() == "targetId: 105 drivenTargetId: 105 enabled: true result: RESULT_TRUE expression: \"a|b|c\" digital { op: OP_DESIRED_IS id: 101 rhs: STATE_ACTIVE } digital { op: OP_DESIRED_IS result: RESULT_TRUE id: 102 rhs: STATE_ACTIVE } digital { op: OP_DESIRED_IS id: 103 rhs: STATE_ACTIVE } digital { op: OP_DESIRED_IS id: 104 rhs: STATE_ACTIVE }");
             }
 
+            {
+                // reading and evaluating the block does not allocate on the heap
+                auto logicPtr = brewbloxBox().makeCboxPtr<ActuatorLogicBlock>(130).lock();
+                REQUIRE(logicPtr);
+                cbox::BlackholeDataOut out;
+                CHECK(allocations::countDuring([&logicPtr, &out]() {
+                          logicPtr->streamTo(out);
+                          logicPtr->evaluate();
+                      }) == 0);
+            }
+
             setAct(101, blox::DigitalState::Inactive);
             setAct(102, blox::DigitalState::Inactive);
             setAct(103, blox::DigitalState::Active);
@@ -354,6 +366,17 @@ SCENARIO("Test", "[maklogicblock]")
             result = setLogic(message);
             CHECK(result.result() == blox::Compare_Result_RESULT_BLOCK_NOT_FOUND);
             CHECK(result.errorpos() == 0);
+
+            // syntax errors are found when the expression is compiled and take precedence over missing blocks
+            message.set_expression("b|(");
+            result = setLogic(message);
+            CHECK(result.result() == blox::Compare_Result_RESULT_MISSING_CLOSE_BRACKET);
+            CHECK(result.errorpos() == 2);
+
+            message.set_expression("a|b");
+            result = setLogic(message);
+            CHECK(result.result() == blox::Compare_Result_RESULT_BLOCK_NOT_FOUND);
+            CHECK(result.errorpos() == 2);
         }
 
         AND_WHEN("Analog comparisons are used")
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The test runner replaces the global operator new to count heap allocations.
+ * Use it to check that code that runs periodically on the device, like reading a block, does not allocate.
+ */
+namespace allocations {
+
+// number of allocations since the test runner started
+uint32_t
+count();
+
+template <typename F>
+uint32_t
+countDuring(F&& func)
+{
+    auto before = count();
+    func();
+    return count() - before;
+}
+
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "StackUsage.h"
+#include "blox/ActuatorAnalogMockBlock.h"
+#include "blox/ActuatorLogicBlock.h"
+#include "blox/ActuatorOffsetBlock.h"
+#include "blox/ActuatorPwmBlock.h"
+#include "blox/BalancerBlock.h"
+#include "blox/DigitalActuatorBlock.h"
+#include "blox/DisplaySettingsBlock.h"
+#include "blox/MockPinsBlock.h"
+#include "blox/MotorValveBlock.h"
+#include "blox/MutexBlock.h"
+#include "blox/PidBlock.h"
+#include "blox/SetpointProfileBlock.h"
+#include "blox/SetpointSensorPairBlock.h"
+#include "blox/TempSensorCombiBlock.h"
+#include "blox/TempSensorMockBlock.h"
+#include "cbox/DataStream.h"
+#include "cbox/ObjectContainer.h"
+#include "proto/cpp/ActuatorLogic.pb.h"
+#include "proto/cpp/DisplaySettings.pb.h"
+#include "proto/cpp/TempSensorCombi.pb.h"
+#include <cstring>
+#include <pb_encode.h>
+
+namespace {
+
+// stack use of a block write on the host, the device uses less because its frames are smaller
+constexpr size_t
+maxWriteStackUse()
+{
+    return 4096;
+}
+
+struct EncodedMessage {
+    uint8_t data[2048];
+    size_t size = 0;
+};
+
+// encode a message like it is received in a write command: zero terminated
+template <typename T>
+EncodedMessage
+encode(const T& message, const pb_field_t fields[])
+{
+    EncodedMessage encoded;
+    pb_ostream_t stream = pb_ostream_from_buffer(encoded.data, sizeof(encoded.data) - 1);
+    REQUIRE(pb_encode(&stream, fields, &message));
+    encoded.data[stream.bytes_written] = 0;
+    encoded.size = stream.bytes_written + 1;
+    return encoded;
+}
+
+size_t
+writeStackUse(cbox::Object& block, const EncodedMessage& message)
+{
+    cbox::CboxError result = cbox::CboxError::OK;
+    auto used = stackusage::during([&block, &message, &result]() {
+        cbox::BufferDataIn in(message.data, message.size);
+        result = block.streamFrom(in);
+    });
+    CHECK(result == cbox::CboxError::OK);
+    return used;
+}
+
+EncodedMessage
+emptyMessage()
+{
+    EncodedMessage encoded;
+    encoded.data[0] = 0;
+    encoded.size = 1;
+    return encoded;
+}
+}
+
+SCENARIO("Writing a block has a bounded peak stack use", "[stack]")
+{
+    cbox::ObjectContainer objects;
+
+    WHEN("An empty message is written to each block")
+    {
+        ActuatorAnalogMockBlock actuatorAnalogMock(objects);
+        ActuatorLogicBlock actuatorLogic(objects);
+        ActuatorOffsetBlock actuatorOffset(objects);
+        ActuatorPwmBlock actuatorPwm(objects);
+        BalancerBlock balancer;
+        DigitalActuatorBlock digitalActuator(objects);
+        DisplaySettingsBlock displaySettings;
+        MockPinsBlock mockPins;
+        MotorValveBlock motorValve(objects);
+        MutexBlock mutex;
+        PidBlock pid(objects);
+        SetpointProfileBlock setpointProfile(objects);
+        SetpointSensorPairBlock setpointSensorPair(objects);
+        TempSensorCombiBlock tempSensorCombi(objects);
+        TempSensorMockBlock tempSensorMock;
+
+        std::pair<const char*, cbox::Object*> blocks[] = {
+            {"ActuatorAnalogMock", &actuatorAnalogMock},
+            {"ActuatorLogic", &actuatorLogic},
+            {"ActuatorOffset", &actuatorOffset},
+            {"ActuatorPwm", &actuatorPwm},
+            {"Balancer", &balancer},
+            {"DigitalActuator", &digitalActuator},
+            {"DisplaySettings", &displaySettings},
+            {"MockPins", &mockPins},
+            {"MotorValve", &motorValve},
+            {"Mutex", &mutex},
+            {"Pid", &pid},
+            {"SetpointProfile", &setpointProfile},
+            {"SetpointSensorPair", &setpointSensorPair},
+            {"TempSensorCombi", &tempSensorCombi},
+            {"TempSensorMock", &tempSensorMock},
+        };
+
+        THEN("The peak stack use of every write is below the maximum")
+        {
+            for (auto& block : blocks) {
+                INFO(block.first);
+                CHECK(writeStackUse(*block.second, emptyMessage()) < maxWriteStackUse());
+            }
+        }
+    }
+
+    WHEN("The largest messages are written with all repeated fields filled")
+    {
+        blox_ActuatorLogic logic = blox_ActuatorLogic_init_zero;
+        logic.digital_count = sizeof(logic.digital) / sizeof(logic.digital[0]);
+        for (pb_size_t i = 0; i < logic.digital_count; i++) {
+            logic.digital[i].id = 200 + i;
+            logic.digital[i].op = blox_Compare_DigitalOperator_OP_VALUE_IS;
+        }
+        logic.analog_count = sizeof(logic.analog) / sizeof(logic.analog[0]);
+        for (pb_size_t i = 0; i < logic.analog_count; i++) {
+            logic.analog[i].id = 300 + i;
+            logic.analog[i].op = blox_Compare_AnalogOperator_OP_VALUE_GE;
+        }
+        memset(logic.expression, 'a', sizeof(logic.expression) - 1);
+
+        blox_DisplaySettings display = blox_DisplaySettings_init_zero;
+        memset(display.name, 'n', sizeof(display.name) - 1);
+        display.widgets_count = sizeof(display.widgets) / sizeof(display.widgets[0]);
+        for (pb_size_t i = 0; i < display.widgets_count; i++) {
+            display.widgets[i].pos = i + 1;
+            memset(display.widgets[i].name, 'w', sizeof(display.widgets[i].name) - 1);
+            display.widgets[i].which_WidgetType = blox_Widget_pid_tag;
+            display.widgets[i].WidgetType.pid = 100 + i;
+        }
+
+        blox_TempSensorCombi combi = blox_TempSensorCombi_init_zero;
+        combi.sensors_count = sizeof(combi.sensors) / sizeof(combi.sensors[0]);
+        for (pb_size_t i = 0; i < combi.sensors_count; i++) {
+            combi.sensors[i] = 100 + i;
+        }
+
+        THEN("The peak stack use does not depend on the size of the message")
+        {
+            ActuatorLogicBlock actuatorLogic(objects);
+            auto logicEmpty = writeStackUse(actuatorLogic, emptyMessage());
+            auto logicFull = writeStackUse(actuatorLogic, encode(logic, blox_ActuatorLogic_fields));
+            CHECK(logicFull < maxWriteStackUse());
+            CHECK(logicFull < logicEmpty + 256);
+
+            DisplaySettingsBlock displaySettings;
+            auto displayEmpty = writeStackUse(displaySettings, emptyMessage());
+            auto displayFull = writeStackUse(displaySettings, encode(display, blox_DisplaySettings_fields));
+            CHECK(displayFull < maxWriteStackUse());
+            CHECK(displayFull < displayEmpty + 256);
+
+            TempSensorCombiBlock tempSensorCombi(objects);
+            CHECK(writeStackUse(tempSensorCombi, encode(combi, blox_TempSensorCombi_fields)) < maxWriteStackUse());
+        }
+    }
+}
@@ -19,6 +19,7 @@
 
 #include <catch.hpp>
 
+#include "AllocationCounter.h"
 #include "BrewBloxTestBox.h"
 #include "Temperature.h"
 #include "blox/ActuatorAnalogMockBlock.h"
@@ -155,6 +156,14 @@ SCENARIO("A Blox Pid object with mock analog actuator")
               "derivativeFilter: FILTER_3m");
     }
 
+    THEN("Reading the block does not allocate on the heap")
+    {
+        auto pidPtr = brewbloxBox().makeCboxPtr<PidBlock>(pidId).lock();
+        REQUIRE(pidPtr);
+        cbox::BlackholeDataOut out;
+        CHECK(allocations::countDuring([&pidPtr, &out]() { pidPtr->streamTo(out); }) == 0);
+    }
+
     THEN("The integral value can be written externally to reset it trough the integralReset field")
     {
 
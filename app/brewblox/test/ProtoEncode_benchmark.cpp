@@ -0,0 +1,132 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares encoding the biggest block messages into a buffer with encoding them field by field to the stream.
+ * It is hidden from the normal test run, run it with:
+ * make benchmark
+ * or
+ * ./build/brewblox_test_runner "[benchmark]"
+ */
+
+#include <catch.hpp>
+
+#include "blox/Block.h"
+#include "cbox/DataStream.h"
+#include "proto/cpp/ActuatorLogic.pb.h"
+#include "proto/cpp/DisplaySettings.pb.h"
+#include "proto/cpp/Pid.pb.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+using EncodeFunction = cbox::CboxError (*)(cbox::DataOut&, const void*, const pb_field_t[], size_t);
+
+// encodes the message the way a read command does: hex encoded to the connection
+double
+timeEncode(EncodeFunction encode, const void* message, const pb_field_t fields[], size_t maxSize, uint32_t repeats, stream_size_t& bytesOut)
+{
+    cbox::CountingBlackholeDataOut connection;
+    cbox::EncodedDataOut hexOut(connection);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < repeats; i++) {
+        encode(hexOut, message, fields, maxSize);
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    bytesOut = connection.count() / repeats;
+    return elapsed / repeats;
+}
+
+void
+compare(const char* name, const void* message, const pb_field_t fields[], size_t maxSize)
+{
+    const uint32_t repeats = 20000;
+    stream_size_t bufferedBytes = 0;
+    stream_size_t callbackBytes = 0;
+    double buffered = timeEncode(streamProtoTo, message, fields, maxSize, repeats, bufferedBytes);
+    double callback = timeEncode(streamProtoToCallback, message, fields, maxSize, repeats, callbackBytes);
+    printf("%-16s %4u bytes hex | buffered %7.3f us | field by field %7.3f us\n",
+           name, unsigned(bufferedBytes), buffered, callback);
+    CHECK(bufferedBytes == callbackBytes);
+}
+}
+
+TEST_CASE("Protobuf encoding benchmark", "[.][benchmark]")
+{
+    blox_Pid pid = blox_Pid_init_zero;
+    pid.inputId = 100;
+    pid.outputId = 101;
+    pid.inputValue = 20 * 4096;
+    pid.inputSetting = 21 * 4096;
+    pid.outputValue = 50 * 4096;
+    pid.outputSetting = 60 * 4096;
+    pid.enabled = true;
+    pid.active = true;
+    pid.kp = 10 * 4096;
+    pid.ti = 2000;
+    pid.td = 200;
+    pid.p = 10 * 4096;
+    pid.i = 5 * 4096;
+    pid.d = -2 * 4096;
+    pid.error = 4096;
+    pid.integral = 1000 * 4096;
+    pid.derivative = -4096;
+    pid.boilPointAdjust = -4096;
+    pid.boilMinOutput = 25 * 4096;
+    pid.drivenOutputId = 101;
+    compare("Pid", &pid, blox_Pid_fields, blox_Pid_size);
+
+    blox_DisplaySettings display = blox_DisplaySettings_init_zero;
+    strncpy(display.name, "Fermentation fridge", sizeof(display.name) - 1);
+    display.tempUnit = 1;
+    display.brightness = 200;
+    display.widgets_count = sizeof(display.widgets) / sizeof(display.widgets[0]);
+    for (pb_size_t i = 0; i < display.widgets_count; i++) {
+        auto& widget = display.widgets[i];
+        widget.pos = i + 1;
+        widget.color[0] = 0xFF;
+        widget.color[1] = 0x80;
+        widget.color[2] = 0x20;
+        strncpy(widget.name, "Beer temp", sizeof(widget.name) - 1);
+        widget.which_WidgetType = blox_Widget_pid_tag;
+        widget.WidgetType.pid = 100 + i;
+    }
+    compare("DisplaySettings", &display, blox_DisplaySettings_fields, blox_DisplaySettings_size);
+
+    blox_ActuatorLogic logic = blox_ActuatorLogic_init_zero;
+    logic.targetId = 100;
+    logic.enabled = true;
+    logic.drivenTargetId = 100;
+    logic.digital_count = sizeof(logic.digital) / sizeof(logic.digital[0]);
+    for (pb_size_t i = 0; i < logic.digital_count; i++) {
+        logic.digital[i].id = 200 + i;
+        logic.digital[i].op = blox_Compare_DigitalOperator_OP_VALUE_IS;
+        logic.digital[i].rhs = blox_DigitalState_STATE_ACTIVE;
+    }
+    logic.analog_count = sizeof(logic.analog) / sizeof(logic.analog[0]);
+    for (pb_size_t i = 0; i < logic.analog_count; i++) {
+        logic.analog[i].id = 300 + i;
+        logic.analog[i].op = blox_Compare_AnalogOperator_OP_VALUE_GE;
+        logic.analog[i].rhs = 20 * 4096;
+    }
+    strncpy(logic.expression, "(a|b)&(c|d)&!(e^f)|(g&h&i)|(A&B)|(C|D)", sizeof(logic.expression) - 1);
+    compare("ActuatorLogic", &logic, blox_ActuatorLogic_fields, blox_ActuatorLogic_size);
+}
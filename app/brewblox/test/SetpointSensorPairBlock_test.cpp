@@ -23,7 +23,9 @@
 #include <iostream>
 
 #include "../BrewBlox.h"
+#include "AllocationCounter.h"
 #include "BrewBloxTestBox.h"
+#include "SensorFilterCache.h"
 #include "Temperature.h"
 #include "blox/SetpointSensorPairBlock.h"
 #include "blox/TempSensorMockBlock.h"
@@ -126,6 +128,52 @@ SCENARIO("A Blox SetpointSensorPair object can be created from streamed protobuf
                   "strippedFields: 6 "
                   "strippedFields: 11");
         }
+
+        AND_THEN("Reading the block with stripped fields does not allocate on the heap")
+        {
+            auto pairPtr = brewbloxBox().makeCboxPtr<SetpointSensorPairBlock>(101).lock();
+            REQUIRE(pairPtr);
+            cbox::BlackholeDataOut out;
+            CHECK(allocations::countDuring([&pairPtr, &out]() { pairPtr->streamTo(out); }) == 0);
+        }
+    }
+
+    WHEN("A second pair is created for the same sensor")
+    {
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::CREATE_OBJECT);
+        testBox.put(cbox::obj_id_t(102));
+        testBox.put(uint8_t(0xFF));
+        testBox.put(SetpointSensorPairBlock::staticTypeId());
+        testBox.put(newPair);
+
+        testBox.processInput();
+        CHECK(testBox.lastReplyHasStatusOk());
+
+        THEN("Both pairs share the filter of the sensor")
+        {
+            CHECK(sensorFilterCache().size() == 1);
+        }
+
+        AND_WHEN("The second pair is written with a filter reset trigger")
+        {
+            testBox.put(uint16_t(0)); // msg id
+            testBox.put(commands::WRITE_OBJECT);
+            testBox.put(cbox::obj_id_t(102));
+            testBox.put(uint8_t(0xFF));
+            testBox.put(SetpointSensorPairBlock::staticTypeId());
+
+            newPair.set_resetfilter(true);
+            testBox.put(newPair);
+
+            testBox.processInput();
+            CHECK(testBox.lastReplyHasStatusOk());
+
+            THEN("It continues with a filter of its own, so the first pair keeps its history")
+            {
+                CHECK(sensorFilterCache().size() == 2);
+            }
+        }
     }
 
     WHEN("The mock sensor value is changed to 25")
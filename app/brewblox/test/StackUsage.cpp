@@ -0,0 +1,45 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StackUsage.h"
+
+namespace {
+constexpr char pattern = char(0xA5);
+}
+
+// the stack of paint itself is above the painted area, below its own frame everything is unused
+__attribute__((noinline)) void
+stackusage::paint(const char* top)
+{
+    volatile char* bottom = const_cast<char*>(top) - maxDepth();
+    volatile char* end = static_cast<char*>(__builtin_frame_address(0)) - 256;
+    for (volatile char* p = bottom; p < end; ++p) {
+        *p = pattern;
+    }
+}
+
+__attribute__((noinline)) size_t
+stackusage::highWaterMark(const char* top)
+{
+    const volatile char* p = top - maxDepth();
+    while (p < top && *p == pattern) {
+        ++p;
+    }
+    return top - p;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Measures the peak stack use of a function by filling the unused stack below the caller with a pattern
+ * and finding the deepest byte that was overwritten after the function returns.
+ */
+namespace stackusage {
+
+// maximum stack depth that is measured
+constexpr size_t
+maxDepth()
+{
+    return 32768;
+}
+
+void
+paint(const char* top);
+
+size_t
+highWaterMark(const char* top);
+
+template <typename F>
+size_t
+during(F&& func)
+{
+    const char* top = static_cast<const char*>(__builtin_frame_address(0));
+    paint(top);
+    func();
+    return highWaterMark(top);
+}
+
+}
@@ -8,6 +8,8 @@ DEVICE_KEY="$EXECUTABLE_DIR/device_key.der"
 SERVER_KEY="$EXECUTABLE_DIR/server_key.der"
 # EEPROM_FILE="$EXECUTABLE_DIR/eeprom.bin"
 STATE_DIR="$EXECUTABLE_DIR/state"
+# blocks are stored in a memory mapped file
+export BREWBLOX_EEPROM_FILE="$STATE_DIR/brewblox-eeprom.bin"
 
 ls "$EXECUTABLE" 
 if [ ! -f "$EXECUTABLE" ]; then
@@ -38,14 +38,14 @@ public:
     }
     virtual ~ArrayEepromAccess() = default;
 
-    virtual uint8_t readByte(uint16_t offset) const override final
+    virtual uint8_t readByte(eeprom_offset_t offset) const override final
     {
         if (isValidRange(offset, 1))
             return data[offset];
         return 0;
     }
 
-    virtual void writeByte(uint16_t offset, uint8_t value) override final
+    virtual void writeByte(eeprom_offset_t offset, uint8_t value) override final
     {
         if (isValidRange(offset, 1)) {
             data[offset] = value;
@@ -53,13 +53,13 @@ public:
         }
     }
 
-    virtual void readBlock(uint8_t* target, uint16_t offset, uint16_t size) const override final
+    virtual void readBlock(uint8_t* target, eeprom_offset_t offset, eeprom_offset_t size) const override final
     {
         if (isValidRange(offset, size))
             memcpy(target, &data[offset], size);
     }
 
-    virtual void writeBlock(uint16_t offset, const uint8_t* source, uint16_t size) override final
+    virtual void writeBlock(eeprom_offset_t offset, const uint8_t* source, eeprom_offset_t size) override final
     {
         if (isValidRange(offset, size)) {
             memcpy(&data[offset], source, size);
@@ -72,7 +72,7 @@ public:
         return &data[0];
     }
 
-    virtual uint16_t length() const override final
+    virtual eeprom_offset_t length() const override final
     {
         return eeprom_size;
     }
@@ -82,6 +82,10 @@ public:
         memset(&data, 0, sizeof(data));
     }
 
+    virtual void flush() override final
+    {
+    }
+
     /**
 	 * Determines if the contents have changed since the last call to change.
 	 * @return
@@ -99,7 +103,7 @@ protected:
         changed = true;
     }
 
-    bool isValidRange(uint16_t offset, uint16_t size) const
+    bool isValidRange(eeprom_offset_t offset, eeprom_offset_t size) const
     {
         bool valid = offset >= 0 && offset < length()
                      && size <= length() && offset + size <= length();
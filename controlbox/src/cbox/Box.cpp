@@ -204,7 +204,7 @@ Box::createObjectFromStream(DataIn& in)
         return std::make_tuple(CboxError::INPUT_STREAM_READ_ERROR, std::shared_ptr<Object>(), uint8_t(0)); // LCOV_EXCL_LINE
     }
 
-    auto retv = factory.make(typeId);
+    auto retv = factory.make(typeId, objects);
     auto result = std::get<0>(retv);
     auto obj = std::get<1>(retv);
 
@@ -444,7 +444,7 @@ Box::loadObjectsFromStorage()
         obj_id_t objId = obj_id_t(id);
         CboxError status = CboxError::OK;
 
-        tracing::add(tracing::Action::LOAD_STORED_OBJECT, objId, obj_type_t(0));
+        tracing::Scope<tracing::OBJECT_STORAGE> trace(tracing::Action::LOAD_STORED_OBJECT, objId, obj_type_t(0));
 
         // use a CrcDataOut to a black hole to check the CRC
         BlackholeDataOut hole;
@@ -483,7 +483,8 @@ Box::loadObjectsFromStorage()
         return status;
     };
     // now apply the loader above to all objects in storage
-    storage.retrieveObjects(objectLoader);
+    // storage is read into a temporary RAM buffer first, because that is much faster than reading byte by byte
+    storage.retrieveObjectsBuffered(objectLoader);
 
     // add deprecated object placeholders at the end
     for (auto& id : deprecatedList) {
@@ -611,8 +612,11 @@ Box::discoverNewObjects(DataIn& in, EncodedDataOut& out)
  *   this data.
  */
 void
-Box::handleCommand(DataIn& dataIn, DataOut& dataOut)
+Box::handleCommand(DataIn& rawIn, DataOut& rawOut)
 {
+    MicrosTimer timer;
+    CountingDataIn dataIn(rawIn);
+    CountingDataOut dataOut(rawOut);
     HexTextToBinaryIn hexIn(dataIn);
     EncodedDataOut out(dataOut); // hex encodes and adds CRC after response, supports protocol special characters
     TeeDataIn in(hexIn, out);    // ensure command input is also echoed to output
@@ -621,7 +625,7 @@ Box::handleCommand(DataIn& dataIn, DataOut& dataOut)
     uint8_t cmd_id = in.next(); // get command type code
 
     if (cmd_id < 100) {
-        tracing::add(tracing::Action(cmd_id)); // non-custom commands trace that they are invoked
+        tracing::Scope<tracing::COMMANDS> trace(cmd_id); // non-custom commands trace that they are invoked and their duration
         switch (cmd_id) {
         case NONE:
             connectionStarted(dataOut); // insert welcome message annotation
@@ -677,6 +681,26 @@ Box::handleCommand(DataIn& dataIn, DataOut& dataOut)
     hexIn.unBlock(); // consumes any leftover \r or \n
 
     out.endMessage();
+
+    auto& stats = commandStats[std::min(size_t(cmd_id), commandStats.size() - 1)];
+    stats.add(dataIn.count(), dataOut.count(), timer.elapsed());
+}
+
+bool
+Box::streamStatsTo(DataOut& out) const
+{
+    bool success = out.put(uint8_t(commandStats.size()));
+    for (auto& stats : commandStats) {
+        success = success && stats.streamTo(out);
+    }
+    return success && connections.streamStatsTo(out);
+}
+
+void
+Box::resetStats()
+{
+    commandStats.fill(TrafficStats());
+    connections.resetStats();
 }
 
 void
@@ -38,7 +38,7 @@ private:
     // A single container is used for both system and user objects.
     // The application can add the system objects first, then set the start ID to a higher value.
     // The objects with an ID lower than the start ID cannot be deleted.
-    const ObjectFactory& factory;
+    const ObjectFactory factory;
     ObjectContainer& objects;
     ObjectStorage& storage;
     // Box receives commands from connections in the connection pool and streams back the answer to the same connection
@@ -46,6 +46,8 @@ private:
     std::vector<std::unique_ptr<ScanningFactory>> scanners;
     uint8_t activeGroups = 0x81; // system group and first user group
     update_t lastUpdateTime = 0;
+    // statistics per command id. The last entry is used for all application commands and invalid commands
+    std::array<TrafficStats, 14> commandStats;
 
     // command handlers
     void noop(DataIn& in, EncodedDataOut& out);
@@ -99,7 +101,7 @@ public:
     void update(const update_t& now)
     {
         lastUpdateTime = now;
-        tracing::add(cbox::tracing::Action::UPDATE_OBJECTS);
+        tracing::Scope<tracing::SYSTEM> trace(tracing::Action::UPDATE_OBJECTS);
         objects.update(now);
     }
 
@@ -164,6 +166,11 @@ public:
     {
         objects.clearAll();
     }
+
+    // write traffic and latency statistics per command type and per connection, see docs/comms-stats.md
+    bool streamStatsTo(DataOut& out) const;
+
+    void resetStats();
 };
 
 bool
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Box.h"
+#include "Connections.h"
+#include "DataStream.h"
+#include "LogQueue.h"
+#include "SpscRingBuffer.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace cbox {
+
+/**
+ * Splits communication over two threads, so reading and writing connections doesn't delay the control loop.
+ *
+ * - The communication thread calls receive(). It reads complete request lines from all connections and
+ *   queues them, and sends queued replies to the connection that sent the request.
+ * - The control thread calls execute(). It handles the queued requests with Box::handleCommand and queues the replies.
+ *
+ * Both queues are lock free single producer, single consumer rings. Objects are only accessed by the control thread,
+ * so they don't need locking: commands run between object updates, like they do without a communication thread.
+ * The connection pool is only used by the communication thread. Log messages are redirected to the control thread,
+ * so they must be logged from the control thread.
+ *
+ * Requests are queued as: connection id (4), stream type (1), length (2), request line.
+ * Replies are queued in chunks of: connection id (4), length (1), data. Connection id 0 sends data to all connections.
+ *
+ * When the request queue is full, the connection is not read until the request fits.
+ * When the reply queue is more than half full, execute() returns and handles the remaining requests on the next call.
+ * A reply that doesn't fit waits for the communication thread to send queued replies.
+ * A request line that is longer than half the request queue is dropped.
+ */
+template <size_t RequestCapacity = 4096, size_t ReplyCapacity = 4096>
+class CommandQueue {
+private:
+    using Logs = LogQueue<512>;
+
+    static constexpr size_t requestHeaderLength()
+    {
+        return 7;
+    }
+
+    static constexpr size_t replyHeaderLength()
+    {
+        return 5;
+    }
+
+    static constexpr size_t maxRequestLength()
+    {
+        return RequestCapacity / 2;
+    }
+
+    /**
+     * Buffers reply data on the control thread and queues it in chunks for one connection
+     */
+    class ReplyDataOut final : public DataOut {
+    private:
+        SpscRingBuffer<ReplyCapacity>& queue;
+        uint32_t id;
+        uint8_t chunk[64];
+        uint8_t len = 0;
+
+    public:
+        ReplyDataOut(SpscRingBuffer<ReplyCapacity>& _queue, uint32_t _id)
+            : queue(_queue)
+            , id(_id)
+        {
+        }
+        virtual ~ReplyDataOut()
+        {
+            flush();
+        }
+
+        using DataOut::writeBuffer;
+
+        virtual bool write(uint8_t data) override final
+        {
+            if (len == sizeof(chunk)) {
+                flush();
+            }
+            chunk[len++] = data;
+            return true;
+        }
+
+        /**
+         * Queue the buffered data. Waits for the communication thread when the queue is full.
+         */
+        void flush()
+        {
+            if (len == 0) {
+                return;
+            }
+            while (queue.space() < replyHeaderLength() + len) {
+                std::this_thread::yield();
+            }
+            uint8_t header[replyHeaderLength()];
+            std::copy(reinterpret_cast<const uint8_t*>(&id), reinterpret_cast<const uint8_t*>(&id) + sizeof(id), header);
+            header[4] = len;
+            queue.push(header, replyHeaderLength());
+            queue.push(chunk, len);
+            len = 0;
+        }
+    };
+
+    struct PendingRequest {
+        uint32_t id;
+        std::vector<uint8_t> line;
+        bool complete = false;
+        bool discarding = false; // the line was too long, skip to the next line
+        bool seen = true;
+    };
+
+    Box& box;
+    ConnectionPool& connections;
+
+    // communication thread
+    SpscRingBuffer<RequestCapacity> requests;
+    std::vector<PendingRequest> pending;
+    std::atomic<uint32_t> dropped{0};
+
+    // control thread
+    SpscRingBuffer<ReplyCapacity> replies;
+    Logs logs;
+    bool executing = false;
+    uint8_t requestBuffer[maxRequestLength()];
+
+public:
+    CommandQueue(Box& _box, ConnectionPool& _connections)
+        : box(_box)
+        , connections(_connections)
+    {
+        connections.setLogHandler([this](const char* prefix, const char* text, size_t len) {
+            logs.push(executing ? Logs::Target::CURRENT : Logs::Target::ALL, prefix, text, len);
+        });
+    }
+
+    ~CommandQueue()
+    {
+        connections.setLogHandler(nullptr);
+    }
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    /**
+     * Send queued replies and queue new requests. Called by the communication thread.
+     */
+    void receive()
+    {
+        sendReplies();
+        for (auto& p : pending) {
+            p.seen = false;
+        }
+        connections.process([this](uint32_t id, DataIn& in, DataOut&) {
+            readRequests(id, in);
+        });
+        // forget partial requests of closed connections
+        pending.erase(
+            std::remove_if(pending.begin(), pending.end(), [](const PendingRequest& p) { return !p.seen; }),
+            pending.end());
+    }
+
+    /**
+     * Handle all queued requests. Called by the control thread.
+     */
+    void execute()
+    {
+        ReplyDataOut all(replies, 0);
+        logs.drain(all, all); // messages logged outside of commands, for example during object updates
+
+        uint8_t header[requestHeaderLength()];
+        // leave the remaining requests for the next call when the communication thread is behind with sending replies
+        while (replies.space() >= ReplyCapacity / 2 && requests.peek(header, requestHeaderLength())) {
+            uint32_t id;
+            std::copy(header, header + sizeof(id), reinterpret_cast<uint8_t*>(&id));
+            auto type = StreamType(header[4]);
+            uint16_t len = uint16_t(header[5]) | uint16_t(header[6]) << 8;
+            if (requests.size() < requestHeaderLength() + len) {
+                break; // LCOV_EXCL_LINE the request is pushed after the header
+            }
+            requests.pop(header, requestHeaderLength());
+            requests.pop(requestBuffer, len);
+
+            BufferDataIn in(requestBuffer, len, type);
+            ReplyDataOut out(replies, id);
+            executing = true;
+            while (in.hasNext()) {
+                box.handleCommand(in, out);
+            }
+            executing = false;
+            logs.drain(out, all);
+        }
+    }
+
+    // number of requests dropped because they were too long
+    uint32_t droppedRequests() const
+    {
+        return dropped;
+    }
+
+private:
+    void sendReplies()
+    {
+        uint8_t header[replyHeaderLength()];
+        uint8_t data[255];
+        while (replies.peek(header, replyHeaderLength())) {
+            uint32_t id;
+            std::copy(header, header + sizeof(id), reinterpret_cast<uint8_t*>(&id));
+            uint8_t len = header[4];
+            if (replies.size() < replyHeaderLength() + len) {
+                break; // LCOV_EXCL_LINE the data is pushed after the header
+            }
+            replies.pop(header, replyHeaderLength());
+            replies.pop(data, len);
+            connections.write(id, data, len); // data for closed connections is discarded
+        }
+    }
+
+    void readRequests(uint32_t id, DataIn& in)
+    {
+        auto it = std::find_if(pending.begin(), pending.end(), [id](const PendingRequest& p) { return p.id == id; });
+        if (it == pending.end()) {
+            pending.push_back(PendingRequest{id, {}});
+            it = pending.end() - 1;
+        }
+        auto& p = *it;
+        p.seen = true;
+
+        while (true) {
+            if (p.complete) {
+                if (!queueRequest(id, in.streamType(), p.line)) {
+                    return; // read again when the control thread has made room
+                }
+                p.line.clear();
+                p.complete = false;
+            }
+            if (!in.hasNext()) {
+                return;
+            }
+            uint8_t c = in.next();
+            if (p.discarding) {
+                p.discarding = c != '\n';
+                continue;
+            }
+            p.line.push_back(c);
+            if (c == '\n') {
+                p.complete = true;
+            } else if (p.line.size() >= maxRequestLength()) {
+                p.line.clear();
+                p.discarding = true;
+                ++dropped;
+            }
+        }
+    }
+
+    bool queueRequest(uint32_t id, StreamType type, const std::vector<uint8_t>& line)
+    {
+        if (requests.space() < requestHeaderLength() + line.size()) {
+            return false;
+        }
+        uint8_t header[requestHeaderLength()];
+        std::copy(reinterpret_cast<const uint8_t*>(&id), reinterpret_cast<const uint8_t*>(&id) + sizeof(id), header);
+        header[4] = uint8_t(type);
+        header[5] = uint8_t(line.size());
+        header[6] = uint8_t(line.size() >> 8);
+        requests.push(header, requestHeaderLength());
+        requests.push(line.data(), line.size());
+        return true;
+    }
+};
+
+} // end namespace cbox
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "DataStream.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace cbox {
+
+/**
+ * Traffic and latency statistics for a connection or a command type.
+ * Latency is counted in a histogram with decade buckets:
+ * < 100us, < 1ms, < 10ms, < 100ms, < 1s, >= 1s
+ */
+struct TrafficStats {
+    static constexpr uint8_t numBuckets = 6;
+
+    uint32_t count = 0;
+    uint32_t bytesIn = 0;
+    uint32_t bytesOut = 0;
+    uint32_t totalMicros = 0;
+    uint32_t maxMicros = 0;
+    std::array<uint32_t, numBuckets> histogram = {{0}};
+
+    void add(uint32_t in, uint32_t out, uint32_t micros)
+    {
+        ++count;
+        bytesIn += in;
+        bytesOut += out;
+        totalMicros += micros;
+        maxMicros = std::max(maxMicros, micros);
+        ++histogram[bucket(micros)];
+    }
+
+    static uint8_t bucket(uint32_t micros)
+    {
+        uint8_t b = 0;
+        uint32_t limit = 100;
+        while (b < numBuckets - 1 && micros >= limit) {
+            ++b;
+            limit *= 10;
+        }
+        return b;
+    }
+
+    // binary format, see docs/comms-stats.md
+    bool streamTo(DataOut& out) const
+    {
+        bool success = out.put(count) && out.put(bytesIn) && out.put(bytesOut) && out.put(totalMicros) && out.put(maxMicros);
+        for (auto& b : histogram) {
+            success = success && out.put(b);
+        }
+        return success;
+    }
+};
+
+/**
+ * Measures the duration of a scope with clockMicros()
+ */
+class MicrosTimer {
+public:
+    MicrosTimer()
+        : start(clockMicros())
+    {
+    }
+
+    uint32_t elapsed() const
+    {
+        return clockMicros() - start;
+    }
+
+private:
+    uint32_t start;
+};
+
+} // end namespace cbox
@@ -19,12 +19,16 @@
  */
 
 #pragma once
+#include "CommsStats.h"
 #include "CompositeDataStream.h"
 #include "DataStream.h"
 #include "DataStreamConverters.h"
+#include "LogQueue.h"
+#include "QueuedDataOut.h"
 #include "Tracing.h"
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace cbox {
@@ -49,6 +53,37 @@ public:
     virtual DataIn& getDataIn() = 0;
     virtual bool isConnected() = 0;
     virtual void stop() = 0;
+
+    // send buffered output, without blocking
+    virtual void flush()
+    {
+    }
+
+    // number of bytes waiting to be sent
+    virtual size_t queuedOutput() const
+    {
+        return 0;
+    }
+
+    TrafficStats& stats()
+    {
+        return trafficStats;
+    }
+
+    // unique id, assigned by the connection pool
+    uint32_t id() const
+    {
+        return connectionId;
+    }
+
+    void setId(uint32_t newId)
+    {
+        connectionId = newId;
+    }
+
+private:
+    TrafficStats trafficStats;
+    uint32_t connectionId = 0;
 };
 
 class ConnectionSource {
@@ -60,6 +95,18 @@ public:
 
     virtual void start() = 0;
     virtual void stop() = 0;
+
+    // capacity of the output queue of each connection, 0 if output is not queued
+    virtual uint32_t queueCapacity() const
+    {
+        return 0;
+    }
+
+    // counters of the output queues of all connections of this source, null if output is not queued
+    virtual const QueuedDataOutStats* queueStats() const
+    {
+        return nullptr;
+    }
 };
 
 template <class S>
@@ -218,6 +265,64 @@ public:
     StreamConnection(const StreamConnection& other) = delete; // not copyable
 };
 
+/**
+ * A connection that queues its output and sends it without blocking. See QueuedDataOut.
+ * When reply data didn't fit in the queue, the connection reports that it is disconnected, so the pool will close it.
+ */
+template <typename T, size_t N>
+class QueuedStreamConnection : public Connection {
+private:
+    T stream;
+    StreamDataIn<T> in;
+    QueuedDataOut<T, N> out;
+
+public:
+    QueuedStreamConnection(T&& _stream, QueuedDataOutStats& stats)
+        : stream(std::move(_stream))
+        , in(stream)
+        , out(stream, stats)
+    {
+    }
+    virtual ~QueuedStreamConnection() = default;
+
+    virtual DataOut& getDataOut() override
+    {
+        return out;
+    }
+
+    virtual DataIn& getDataIn() override
+    {
+        return in;
+    }
+
+    virtual bool isConnected() override
+    {
+        return stream.status() && !out.hasOverflowed();
+    }
+
+    virtual void flush() override
+    {
+        out.flush();
+    }
+
+    virtual size_t queuedOutput() const override
+    {
+        return out.queued();
+    }
+
+    static constexpr size_t queueCapacity()
+    {
+        return N;
+    }
+
+    T& get()
+    {
+        return stream;
+    }
+
+    QueuedStreamConnection(const QueuedStreamConnection& other) = delete; // not copyable
+};
+
 extern void
 connectionStarted(DataOut& out);
 
@@ -227,18 +332,26 @@ private:
     std::vector<std::unique_ptr<Connection>> connections;
 
     CompositeDataOut<decltype(connections)> allConnectionsDataOut;
-    DataOut* currentDataOut;
+    using Logs = LogQueue<512>;
+    Logs logQueue;
+    bool processing = false;
+    bool disconnectRequested = false;
+    std::function<void(const char* prefix, const char* text, size_t len)> logHandler;
+    uint32_t lastId = 0;
+    // Guards the connections, so statistics can be read while connections are processed by another thread.
+    // It is recursive, because a command handler can read the statistics while its connection is processed.
+    mutable std::recursive_mutex mutex;
 
 public:
     ConnectionPool(std::initializer_list<std::reference_wrapper<ConnectionSource>> list)
         : connectionSources(list)
         , allConnectionsDataOut(connections, [](const decltype(connections)::value_type& conn) -> DataOut& { return conn->getDataOut(); })
-        , currentDataOut(&allConnectionsDataOut)
     {
     }
 
     void updateConnections()
     {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
         connections.erase(
             std::remove_if(connections.begin(), connections.end(), [](const decltype(connections)::value_type& conn) {
                 return !conn->isConnected(); // remove disconnected connections from pool
@@ -249,13 +362,18 @@ public:
             while (true) {
                 auto con = source.get().newConnection();
                 if (con) {
-                    if (connections.size() >= 4) {
+                    if (connections.size() >= maxConnections()) {
                         auto oldest = connections.begin();
                         auto& out = (*oldest)->getDataOut();
                         const char message[] = "<!Max connections exceeded, closing oldest>";
                         out.writeBuffer(message, sizeof(message) / sizeof(message[0]));
+                        (*oldest)->flush();
                         connections.erase(oldest);
                     }
+                    if (++lastId == 0) {
+                        ++lastId; // id 0 is not used
+                    }
+                    con->setId(lastId);
                     auto& out = con->getDataOut();
                     connectionStarted(out);
                     connections.push_back(std::move(con));
@@ -271,26 +389,160 @@ public:
         return connections.size();
     }
 
+    static constexpr size_t maxConnections()
+    {
+        return 4;
+    }
+
     void process(std::function<void(DataIn& in, DataOut& out)> handler)
     {
-        tracing::add(tracing::Action::UPDATE_CONNECTIONS);
+        process([&handler](uint32_t, DataIn& in, DataOut& out) {
+            handler(in, out);
+        });
+    }
+
+    /**
+     * Process all connections, the handler also receives the id of the connection
+     */
+    void process(std::function<void(uint32_t id, DataIn& in, DataOut& out)> handler)
+    {
+        tracing::Scope<tracing::SYSTEM> trace(tracing::Action::UPDATE_CONNECTIONS);
+        // held while iterating, so another thread cannot change the connections
+        std::lock_guard<std::recursive_mutex> lock(mutex);
         updateConnections();
+        // messages logged outside of processing go to all connections
+        logQueue.drain(allConnectionsDataOut, allConnectionsDataOut);
         for (auto& conn : connections) {
             DataIn& in = conn->getDataIn();
             DataOut& out = conn->getDataOut();
-            currentDataOut = &out;
-            handler(in, out);
+            CountingDataIn countingIn(in);
+            CountingDataOut countingOut(out);
+            MicrosTimer timer;
+            processing = true;
+            handler(conn->id(), countingIn, countingOut);
+            processing = false;
+            if (countingIn.count() || countingOut.count()) {
+                conn->stats().add(countingIn.count(), countingOut.count(), timer.elapsed());
+            }
+            // messages logged while handling a command go to the connection that sent the command, after the reply
+            logQueue.drain(out, allConnectionsDataOut);
+            conn->flush();
+        }
+        if (disconnectRequested) {
+            disconnectRequested = false;
+            connections.clear();
         }
-        currentDataOut = &allConnectionsDataOut;
     }
 
-    DataOut& logDataOut() const
+    /**
+     * Queue a log message or event, which is sent as an annotation: <prefix + text>.
+     * While a command is processed, it is sent to the connection that sent the command. Otherwise it is sent to all connections.
+     * It only copies the message to a queue, connections are written to in process().
+     */
+    void log(const char* prefix, const char* text, size_t len)
     {
-        return *currentDataOut;
+        if (logHandler) {
+            logHandler(prefix, text, len);
+            return;
+        }
+        logQueue.push(processing ? Logs::Target::CURRENT : Logs::Target::ALL, prefix, text, len);
+    }
+
+    /**
+     * Handle log messages elsewhere instead of queueing them in the pool.
+     * Used when commands are not executed on the thread that processes the connections.
+     */
+    void setLogHandler(std::function<void(const char* prefix, const char* text, size_t len)> handler)
+    {
+        logHandler = std::move(handler);
+    }
+
+    /**
+     * Write data to a single connection
+     * @param id: id of the connection, 0 writes to all connections
+     * @return false if no connection with the id exists
+     */
+    bool write(uint32_t id, const uint8_t* data, size_t len)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        if (id == 0) {
+            allConnectionsDataOut.writeBuffer(data, len);
+            return true;
+        }
+        for (auto& conn : connections) {
+            if (conn->id() == id) {
+                conn->getDataOut().writeBuffer(data, len);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // number of log messages dropped since boot because the log queue was full
+    uint32_t droppedLogMessages() const
+    {
+        return logQueue.droppedCount();
+    }
+
+    /**
+     * Write the statistics of all connections, see docs/comms-stats.md
+     */
+    bool streamStatsTo(DataOut& out) const
+    {
+        // copy the statistics first, the output can wait for the thread that processes connections
+        struct {
+            StreamType type;
+            uint32_t queued;
+            TrafficStats stats;
+        } copies[maxConnections()];
+        uint8_t n = 0;
+        std::vector<std::pair<uint32_t, QueuedDataOutStats>> sources;
+        sources.reserve(connectionSources.size());
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+            for (auto& conn : connections) {
+                copies[n++] = {conn->getDataIn().streamType(), uint32_t(conn->queuedOutput()), conn->stats()};
+            }
+            for (auto& source : connectionSources) {
+                auto stats = source.get().queueStats();
+                sources.emplace_back(source.get().queueCapacity(), stats ? *stats : QueuedDataOutStats());
+            }
+        }
+
+        bool success = out.put(n);
+        for (uint8_t i = 0; i < n; ++i) {
+            success = success
+                      && out.put(uint8_t(copies[i].type))
+                      && out.put(copies[i].queued)
+                      && copies[i].stats.streamTo(out);
+        }
+        success = success && out.put(droppedLogMessages());
+
+        success = success && out.put(uint8_t(sources.size()));
+        for (auto& source : sources) {
+            success = success
+                      && out.put(source.first)
+                      && source.second.streamTo(out);
+        }
+        return success;
+    }
+
+    void resetStats()
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        for (auto& conn : connections) {
+            conn->stats() = TrafficStats();
+        }
     }
 
     void disconnect()
     {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        if (processing) {
+            // called by a command handler, the connections are cleared when process() is done with them
+            disconnectRequested = true;
+            return;
+        }
         connections.clear();
     }
 
@@ -40,7 +40,7 @@ public:
         , _nextUpdateTime(0)
     {
         if (_obj) {
-            tracing::add(tracing::Action::CONSTRUCT_OBJECT, _id, _obj->typeId());
+            tracing::add<tracing::OBJECT_STORAGE>(tracing::Action::CONSTRUCT_OBJECT, _id, _obj->typeId());
         }
     }
 
@@ -48,7 +48,7 @@ public:
     {
         if (_obj) {
             // this check is needed because otherwise a trace would be created if a vector is relocated and reserved space is destructed
-            tracing::add(tracing::Action::DESTRUCT_OBJECT, _id, _obj->typeId());
+            tracing::add<tracing::OBJECT_STORAGE>(tracing::Action::DESTRUCT_OBJECT, _id, _obj->typeId());
         }
     }
 
@@ -96,7 +96,7 @@ public:
     void forcedUpdate(const uint32_t& now)
     {
         if (_obj) {
-            tracing::add(tracing::Action::UPDATE_OBJECT, _id, _obj->typeId());
+            tracing::Scope<tracing::OBJECT_UPDATES> trace(tracing::Action::UPDATE_OBJECT, _id, _obj->typeId());
             _nextUpdateTime = _obj->update(now);
             return;
         }
@@ -106,7 +106,7 @@ public:
     CboxError streamTo(DataOut& out) const
     {
         if (_obj) {
-            tracing::add(tracing::Action::STREAM_TO_OBJECT, _id, _obj->typeId());
+            tracing::Scope<tracing::OBJECT_UPDATES> trace(tracing::Action::STREAM_TO_OBJECT, _id, _obj->typeId());
             if (!out.put(_id)) {
                 return CboxError::OUTPUT_STREAM_WRITE_ERROR; // LCOV_EXCL_LINE
             }
@@ -125,7 +125,7 @@ public:
     {
         if (_obj) {
             // id is not streamed in. It is immutable and assumed to be already read to find this entry
-            tracing::add(tracing::Action::STREAM_FROM_OBJECT, _id, _obj->typeId());
+            tracing::Scope<tracing::OBJECT_UPDATES> trace(tracing::Action::STREAM_FROM_OBJECT, _id, _obj->typeId());
             uint8_t newGroups;
             obj_type_t expectedType;
             if (!in.get(newGroups)) {
@@ -154,7 +154,7 @@ public:
     CboxError streamPersistedTo(DataOut& out) const
     {
         if (_obj) {
-            tracing::add(tracing::Action::PERSIST_OBJECT, _id, _obj->typeId());
+            tracing::Scope<tracing::OBJECT_STORAGE> trace(tracing::Action::PERSIST_OBJECT, _id, _obj->typeId());
             // id is not streamed out. It is passed to storage separately
             // if the object is not inactive, we write the groups and typeid to eeprom
             if (_obj->typeId() != InactiveObject::staticTypeId()) {
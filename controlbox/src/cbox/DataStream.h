@@ -211,6 +211,7 @@ enum class StreamType : uint8_t {
     Usb = 1,
     Tcp = 2,
     Eeprom = 3,
+    Unix = 4,
 };
 
 /**
@@ -388,6 +389,75 @@ private:
     DataOut& out2;
 };
 
+/**
+ * A DataIn that counts the bytes read from another DataIn
+ */
+class CountingDataIn final : public DataIn {
+    DataIn& in;
+    uint32_t counted = 0;
+
+public:
+    CountingDataIn(DataIn& _in)
+        : in(_in)
+    {
+    }
+    virtual ~CountingDataIn() = default;
+
+    virtual uint8_t next() override final
+    {
+        ++counted;
+        return in.next();
+    }
+
+    virtual bool hasNext() override final { return in.hasNext(); }
+    virtual uint8_t peek() override final { return in.peek(); }
+    virtual stream_size_t available() override final { return in.available(); }
+
+    virtual StreamType streamType() const override final
+    {
+        return in.streamType();
+    }
+
+    uint32_t count() const
+    {
+        return counted;
+    }
+};
+
+/**
+ * A DataOut that counts the bytes written to another DataOut
+ */
+class CountingDataOut final : public DataOut {
+    DataOut& out;
+    uint32_t counted = 0; // a reply can be larger than stream_size_t
+
+public:
+    CountingDataOut(DataOut& _out)
+        : out(_out)
+    {
+    }
+    virtual ~CountingDataOut() = default;
+
+    using DataOut::writeBuffer;
+
+    virtual bool write(uint8_t data) override final
+    {
+        ++counted;
+        return out.write(data);
+    }
+
+    virtual bool writeBuffer(const uint8_t* data, stream_size_t len) override final
+    {
+        counted += len;
+        return out.writeBuffer(data, len);
+    }
+
+    uint32_t count() const
+    {
+        return counted;
+    }
+};
+
 /**
  * Provides a DataIn stream from a static buffer of data.
  */
@@ -395,12 +465,14 @@ class BufferDataIn : public DataIn {
     const uint8_t* data;
     stream_size_t size;
     stream_size_t pos;
+    StreamType type;
 
 public:
-    BufferDataIn(const uint8_t* buf, stream_size_t len)
+    BufferDataIn(const uint8_t* buf, stream_size_t len, StreamType _type = StreamType::Mock)
         : data(buf)
         , size(len)
         , pos(0)
+        , type(_type)
     {
     }
 
@@ -411,9 +483,16 @@ public:
     void reset() { pos = 0; }
     stream_size_t bytes_read() { return pos; }
 
+    bool skip(stream_size_t skip_length)
+    {
+        auto skip = std::min(skip_length, available());
+        pos += skip;
+        return skip == skip_length;
+    }
+
     virtual StreamType streamType() const override final
     {
-        return StreamType::Mock;
+        return type;
     }
 };
 
@@ -489,6 +568,16 @@ public:
         return false;
     }
 
+    using DataOut::writeBuffer;
+
+    virtual bool writeBuffer(const uint8_t* data, stream_size_t size) override
+    {
+        stream_size_t toWrite = std::min(size, len);
+        len -= toWrite;
+        bool success = out->writeBuffer(data, toWrite);
+        return success && toWrite == size;
+    }
+
     void setLength(stream_size_t len_)
     {
         len = len_;
@@ -540,6 +629,16 @@ public:
         return out.write(data);
     }
 
+    using DataOut::writeBuffer;
+
+    virtual bool writeBuffer(const uint8_t* data, stream_size_t len) override final
+    {
+        for (stream_size_t i = 0; i < len; i++) {
+            crcValue = *(dscrc_table + (crcValue ^ data[i]));
+        }
+        return out.writeBuffer(data, len);
+    }
+
     bool writeCrc()
     {
         return out.write(crcValue);
@@ -594,6 +693,30 @@ public:
         return success;
     }
 
+    using DataOut::writeBuffer;
+
+    /**
+	 * Data is hex-encoded in chunks, which are written to the underlying stream in one call
+	 */
+    virtual bool writeBuffer(const uint8_t* data, stream_size_t len) override final
+    {
+        uint8_t hex[64];
+        while (len > 0) {
+            stream_size_t chunk = std::min(len, stream_size_t(sizeof(hex) / 2));
+            for (stream_size_t i = 0; i < chunk; i++) {
+                crcValue = *(dscrc_table + (crcValue ^ data[i]));
+                hex[2 * i] = d2h(uint8_t(data[i] & 0xF0) >> 4);
+                hex[2 * i + 1] = d2h(uint8_t(data[i] & 0xF));
+            }
+            if (!out.writeBuffer(hex, 2 * chunk)) {
+                return false;
+            }
+            data += chunk;
+            len -= chunk;
+        }
+        return true;
+    }
+
     uint8_t crc()
     {
         return crcValue;
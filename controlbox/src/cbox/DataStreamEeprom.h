@@ -45,7 +45,7 @@ public:
     }
 };
 
-struct EepromStreamRegion : public StreamRegion<uint16_t, stream_size_t> {
+struct EepromStreamRegion : public StreamRegion<eeprom_offset_t, stream_size_t> {
 };
 
 /**
@@ -74,6 +74,20 @@ public:
         }
         return false; // LCOV_EXCL_LINE: doesn't happen if length is managed properly
     }
+
+    using DataOut::writeBuffer;
+
+    /**
+     * Writes the data to eeprom as a single block, instead of byte by byte.
+     */
+    virtual bool writeBuffer(const uint8_t* data, stream_size_t len) override final
+    {
+        stream_size_t toWrite = std::min(len, _length);
+        eepromAccess.writeBlock(_offset, data, toWrite);
+        _offset += toWrite;
+        _length -= toWrite;
+        return toWrite == len;
+    }
 };
 
 /**
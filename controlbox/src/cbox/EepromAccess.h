@@ -22,27 +22,33 @@
 #include <cstdint>
 #include <cstring>
 
+// offsets are 32-bit, so EEPROM implementations are not limited to 64KB
+using eeprom_offset_t = uint32_t;
+
 class EepromAccess {
 public:
     EepromAccess() = default;
     virtual ~EepromAccess() = default;
 
-    virtual uint8_t readByte(uint16_t offset) const = 0;
-    virtual void writeByte(uint16_t offset, uint8_t value) = 0;
-    virtual void readBlock(uint8_t* target, uint16_t offset, uint16_t size) const = 0;
-    virtual void writeBlock(uint16_t target, const uint8_t* source, uint16_t size) = 0;
-    virtual uint16_t length() const = 0;
+    virtual uint8_t readByte(eeprom_offset_t offset) const = 0;
+    virtual void writeByte(eeprom_offset_t offset, uint8_t value) = 0;
+    virtual void readBlock(uint8_t* target, eeprom_offset_t offset, eeprom_offset_t size) const = 0;
+    virtual void writeBlock(eeprom_offset_t target, const uint8_t* source, eeprom_offset_t size) = 0;
+    // total size of the EEPROM. This can differ per platform
+    virtual eeprom_offset_t length() const = 0;
     virtual void clear() = 0;
+    // ensure all written data is persisted
+    virtual void flush() = 0;
 
     template <typename T>
-    T& get(const uint16_t& idx, T& t) const
+    T& get(const eeprom_offset_t& idx, T& t) const
     {
         readBlock(reinterpret_cast<uint8_t*>(&t), idx, sizeof(T));
         return t;
     }
 
     template <typename T>
-    const T& put(const uint16_t& idx, const T& t)
+    const T& put(const eeprom_offset_t& idx, const T& t)
     {
         writeBlock(idx, reinterpret_cast<const uint8_t*>(&t), sizeof(T));
         return t;
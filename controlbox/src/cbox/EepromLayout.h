@@ -1,6 +1,10 @@
+#pragma once
+
+#include "EepromAccess.h"
+#include <cstddef>
 #include <cstdint>
 
-const uint16_t eepromStart = 0;
+const eeprom_offset_t eepromStart = 0;
 
 struct __attribute__((packed)) EepromLayout {
     union {
@@ -10,14 +14,22 @@ struct __attribute__((packed)) EepromLayout {
             uint8_t version;
         } MagicVersion;
     };
-    uint8_t reserved[30];
-    uint8_t objects[2048 - (eepromStart + 2 + 30)];
+    uint16_t objectsLength; // length of the objects region, since storage version 2
+    uint8_t reserved[28];
 };
 
-const uint16_t EepromEnd = eepromStart + sizeof(EepromLayout);
-
 #define EepromLocation(x) (eepromStart + offsetof(struct EepromLayout, x))
 #define EepromLocationEnd(x) (EepromLocation(x) + sizeof(EepromLayout::x))
 #define EepromLocationSize(x) (sizeof(EepromLayout::x))
 
-static_assert(EepromLocationEnd(objects) == 2048, "end of data area is end of 2kb EEPROM");
+// The objects region directly follows the header and runs to the end of EEPROM.
+// The length of EEPROM is a runtime property of EepromAccess.
+const eeprom_offset_t eepromObjectsStart = eepromStart + sizeof(EepromLayout);
+
+// Block sizes are stored as 16 bit values, which limits the length of the objects region
+const eeprom_offset_t eepromObjectsMaxLength = 0xFFFF;
+
+// Storage version 1 had a fixed layout that ended at 2kb
+const eeprom_offset_t eepromObjectsLegacyLength = 2048 - eepromObjectsStart;
+
+static_assert(eepromObjectsStart == 32, "objects start after 32 byte header");
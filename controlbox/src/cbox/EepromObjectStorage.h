@@ -25,6 +25,8 @@
 #include "EepromAccess.h"
 #include "EepromLayout.h"
 #include "ObjectStorage.h"
+#include <memory>
+#include <new>
 
 namespace cbox {
 
@@ -54,6 +56,8 @@ public:
     /**
      * storeObject saves the data streamed by the handler under the given id.
      * it allocates a large enough block in EEPROM automatically and re-allocates if needed.
+     * The data is serialized once to a RAM buffer, which is used to determine the size, calculate the CRC and write to EEPROM.
+     * If the data doesn't fit in the buffer, the handler is called a second time to stream directly to EEPROM.
      * the handler should therefore stream the same data if it is called twice.
      * @param id: id to store the object with
      * @param handler: a callable that is provided with a DataOut to stream the new data to
@@ -67,10 +71,14 @@ public:
             return CboxError::INVALID_OBJECT_ID;
         }
 
-        // write to counter to get size and to do a test serialization
+        // write to buffer and counter to get size and to do a test serialization
+        auto buffer = std::unique_ptr<uint8_t[]>(new (std::nothrow) uint8_t[maxBufferedObjectSize()]);
+        BufferDataOut bufferOut(buffer.get(), buffer ? maxBufferedObjectSize() : 0);
         CountingBlackholeDataOut counter;
-        CboxError res = handler(counter);
+        TeeDataOut bufferAndCounter(bufferOut, counter);
+        CboxError res = handler(bufferAndCounter);
         uint16_t dataSize = counter.count() + 1;
+        bool buffered = counter.count() == bufferOut.bytesWritten();
 
         if (res == CboxError::PERSISTING_NOT_NEEDED) {
             // exit for objects that don't need to exist in EEPROM. Not even their id/groups/existence
@@ -83,10 +91,10 @@ public:
 
         // get actual writable region in eeprom
         RegionDataOut objectEepromData = getObjectWriter(id);
-        uint16_t dataLocation = writer.offset();
+        eeprom_offset_t dataLocation = writer.offset();
         uint16_t blockSize = objectEepromData.availableForWrite();
 
-        auto writeWithCrc = [&id, &objectEepromData, &handler]() -> CboxError {
+        auto writeWithCrc = [&id, &objectEepromData, &handler, &bufferOut, &buffered]() -> CboxError {
             // we want the ID to be part of the CRC
             // we stream it again to a discarded stream and start the actual stream with the resulting CRC
             BlackholeDataOut hole;
@@ -94,7 +102,15 @@ public:
             idCrc.put(id);
 
             CrcDataOut crcOut(objectEepromData, idCrc.crc());
-            CboxError res = handler(crcOut);
+            CboxError res = CboxError::OK;
+            if (buffered) {
+                // write the serialized data as a single block
+                if (!crcOut.writeBuffer(bufferOut.data(), bufferOut.bytesWritten())) {
+                    res = CboxError::PERSISTED_STORAGE_WRITE_ERROR; // LCOV_EXCL_LINE: block size is checked before writing
+                }
+            } else {
+                res = handler(crcOut);
+            }
 
             if (res != CboxError::OK) {
                 crcOut.invalidateCrc();
@@ -129,9 +145,10 @@ public:
 
                 // if there is enough free space, but it is not continuous, do a defrag to and try again
                 defrag();
-                objectEepromData = newObjectWriter(id, requestedSize);
+                objectEepromData = newObjectWriter(0, requestedSize);
                 dataLocation = writer.offset();
-                if (objectEepromData.availableForWrite() < requestedSize) {
+                eepromBlockSize = objectEepromData.availableForWrite();
+                if (eepromBlockSize < requestedSize) {
                     // LCOV_EXCL_LINE still not enough free space, exclude from coverage, because this should not be possible with the check above
                     return CboxError::INSUFFICIENT_PERSISTENT_STORAGE; // LCOV_EXCL_LINE
                 }
@@ -149,6 +166,7 @@ public:
         writer.reset(dataLocation - (objectHeaderLength() - blockHeaderLength()), 2 * sizeof(uint16_t));
         writer.put(actualSize);
         writer.put(id); // overwrite invalid id with actual id
+        eeprom.flush();
         return res;
     }
 
@@ -180,58 +198,29 @@ public:
     retrieveObjects(
         const std::function<CboxError(const storage_id_t& id, RegionDataIn&)>& handler) override final
     {
-        reader.reset(EepromLocation(objects), EepromLocationSize(objects));
-
-        while (reader.hasNext()) {
-            uint8_t type = reader.next();
-            // loop over all blocks and write objects to output stream
-            uint16_t blockSize = 0;
-            if (!reader.get(blockSize)) {
-                return CboxError::COULD_NOT_READ_PERSISTED_BLOCK_SIZE;
-            }
-
-            switch (BlockType(type)) {
-            case BlockType::object: {
-                auto blockData = RegionDataIn(reader, blockSize);
-                auto handleBlock = [&blockData, &handler]() -> CboxError {
-                    if (blockData.available() < sizeof(uint16_t) + sizeof(storage_id_t)) {
-                        return CboxError::PERSISTED_BLOCK_STREAM_ERROR;
-                    }
-                    // first 2 bytes of block are actual data size. Limit reading to this region
-                    uint16_t actualSize;
-                    if (!blockData.get(actualSize)) {
-                        return CboxError::PERSISTED_BLOCK_STREAM_ERROR;
-                    }
-                    storage_id_t id;
-                    if (!blockData.get(id)) {
-                        return CboxError::PERSISTED_BLOCK_STREAM_ERROR;
-                    }
+        resetReader();
+        return retrieveObjectsFrom(reader, handler);
+    }
 
-                    auto objectData = RegionDataIn(blockData, actualSize);
-                    return handler(id, objectData);
-                };
-                auto result = handleBlock();
-                if (result != CboxError::OK) {
-                    if (result == CboxError::PERSISTED_BLOCK_STREAM_ERROR) {
-                        return CboxError::PERSISTED_BLOCK_STREAM_ERROR; // stop on read errors
-                    }
-                    // log event. Do not return, because we do want to handle the next block
-                }
-                reader.skip(blockData.available());
-            } break;
-            case BlockType::disposed_block:
-                if (!reader.skip(blockSize)) {
-                    return CboxError::PERSISTED_BLOCK_STREAM_ERROR;
-                }
-                break;
-            case BlockType::invalid:
-                return CboxError::INVALID_PERSISTED_BLOCK_TYPE; // unknown block type encountered!
-            default:
-                return CboxError::INVALID_PERSISTED_BLOCK_TYPE; // unknown block type encountered!
-                break;
-            }
+    /**
+     * Retreive all objects from storage, like retrieveObjects, but copy the entire objects region to RAM first.
+     * A single block read is much faster than reading EEPROM byte by byte, which matters when loading all objects at boot.
+     * The buffer is only kept for the duration of this call.
+     * If the buffer cannot be allocated, objects are read directly from EEPROM.
+     * @param handler: a callable with the following prototype: (const storage_id_t&, DataOut &) -> CboxError.
+     * @return
+     */
+    virtual CboxError
+    retrieveObjectsBuffered(
+        const std::function<CboxError(const storage_id_t& id, RegionDataIn&)>& handler) override final
+    {
+        auto buffer = std::unique_ptr<uint8_t[]>(new (std::nothrow) uint8_t[objectsLength]);
+        if (!buffer) {
+            return retrieveObjects(handler); // LCOV_EXCL_LINE not enough free RAM
         }
-        return CboxError::OK;
+        eeprom.readBlock(buffer.get(), eepromObjectsStart, objectsLength);
+        BufferDataIn bufferReader(buffer.get(), objectsLength, StreamType::Eeprom);
+        return retrieveObjectsFrom(bufferReader, handler);
     }
 
     virtual bool
@@ -241,14 +230,15 @@ public:
         bool found = false;
         if (block.available() > 0) {
             // overwrite block type with disposed block
-            uint16_t dataStart = reader.offset();
-            uint16_t blockTypeOffset = dataStart - objectHeaderLength();
+            eeprom_offset_t dataStart = reader.offset();
+            eeprom_offset_t blockTypeOffset = dataStart - objectHeaderLength();
             eeprom.writeByte(blockTypeOffset, static_cast<uint8_t>(BlockType::disposed_block));
             found = true;
         }
         if (mergeDisposed) {
             mergeDisposedBlocks();
         }
+        eeprom.flush();
         return found;
     }
 
@@ -289,9 +279,26 @@ public:
         return space;
     }
 
+    /**
+     * Version of the storage format. It is stored in the header, so older images can be migrated.
+     * Version 2 stores the length of the objects region in the header, instead of using a fixed 2kb layout.
+     */
+    static uint8_t
+    storageVersion()
+    {
+        return 0x02;
+    }
+
+    stream_size_t
+    objectsRegionLength() const
+    {
+        return objectsLength;
+    }
+
     void
     defrag()
     {
+        ++defrags;
         // ensure no invalid objects with ID zero remain in eeprom
         // these are only temporary while relocating data
         disposeObject(0);
@@ -300,6 +307,13 @@ public:
         } while (moveDisposedBackwards());
     }
 
+    // number of times defrag has run, for benchmarks
+    uint32_t
+    defragCount() const
+    {
+        return defrags;
+    }
+
 private:
     /**
      * The application supplied EEPROM storage class
@@ -312,31 +326,51 @@ private:
     EepromDataIn reader;
     EepromDataOut writer;
 
+    /**
+     * Length of the objects region, read from the header
+     */
+    stream_size_t objectsLength = 0;
+
+    uint32_t defrags = 0;
+
     inline uint8_t
     magicByte() const
     {
         return 0x69;
     }
-    inline uint8_t
-    storageVersion() const
+    // objects up to this size are serialized only once, to a temporary buffer in RAM
+    static uint16_t
+    maxBufferedObjectSize()
     {
-        return 0x01;
+        return 512;
     }
+
     inline uint16_t
-    referenceHeader() const
+    referenceHeader(uint8_t version = storageVersion()) const
+    {
+        return magicByte() << 8 | version;
+    }
+
+    // length of the objects region if it would span from the end of the header to the end of EEPROM
+    stream_size_t
+    availableObjectsLength() const
     {
-        return magicByte() << 8 | storageVersion();
+        eeprom_offset_t length = eeprom.length();
+        if (length <= eepromObjectsStart) {
+            return 0; // LCOV_EXCL_LINE
+        }
+        return stream_size_t(std::min(length - eepromObjectsStart, eepromObjectsMaxLength));
     }
 
     void
     resetReader()
     {
-        reader.reset(EepromLocation(objects), EepromLocationSize(objects));
+        reader.reset(eepromObjectsStart, objectsLength);
     }
     void
     resetWriter()
     {
-        writer.reset(EepromLocation(objects), EepromLocationSize(objects));
+        writer.reset(eepromObjectsStart, objectsLength);
     }
 
     static uint16_t
@@ -454,9 +488,9 @@ private:
                 return RegionDataOut(writer, availableObjectSize);
             } else {
                 // split into object block and new disposed block
-                uint16_t blockToSplitHeaderStart = reader.offset() - blockHeaderLength();
+                eeprom_offset_t blockToSplitHeaderStart = reader.offset() - blockHeaderLength();
                 uint16_t newDisposedBlockSize = blockSize - neededSizeInclBlockHeader;
-                uint16_t newDisposedBlockStart = blockToSplitHeaderStart + neededSizeInclBlockHeader;
+                eeprom_offset_t newDisposedBlockStart = blockToSplitHeaderStart + neededSizeInclBlockHeader;
 
                 // first disposed block (at the end)
                 writer.reset(newDisposedBlockStart, blockHeaderLength());
@@ -478,20 +512,170 @@ private:
         return RegionDataOut(writer, 0); // length 0 writer
     }
 
+    // Loop over all blocks in the reader and call the handler for each object.
+    // The reader should be positioned at the start of the objects region.
+    template <typename Reader>
+    CboxError
+    retrieveObjectsFrom(
+        Reader& in,
+        const std::function<CboxError(const storage_id_t& id, RegionDataIn&)>& handler)
+    {
+        while (in.hasNext()) {
+            uint8_t type = in.next();
+            // loop over all blocks and write objects to output stream
+            uint16_t blockSize = 0;
+            if (!in.get(blockSize)) {
+                return CboxError::COULD_NOT_READ_PERSISTED_BLOCK_SIZE;
+            }
+
+            switch (BlockType(type)) {
+            case BlockType::object: {
+                auto blockData = RegionDataIn(in, blockSize);
+                auto handleBlock = [&blockData, &handler]() -> CboxError {
+                    if (blockData.available() < sizeof(uint16_t) + sizeof(storage_id_t)) {
+                        return CboxError::PERSISTED_BLOCK_STREAM_ERROR;
+                    }
+                    // first 2 bytes of block are actual data size. Limit reading to this region
+                    uint16_t actualSize;
+                    if (!blockData.get(actualSize)) {
+                        return CboxError::PERSISTED_BLOCK_STREAM_ERROR;
+                    }
+                    storage_id_t id;
+                    if (!blockData.get(id)) {
+                        return CboxError::PERSISTED_BLOCK_STREAM_ERROR;
+                    }
+
+                    auto objectData = RegionDataIn(blockData, actualSize);
+                    return handler(id, objectData);
+                };
+                auto result = handleBlock();
+                if (result != CboxError::OK) {
+                    if (result == CboxError::PERSISTED_BLOCK_STREAM_ERROR) {
+                        return CboxError::PERSISTED_BLOCK_STREAM_ERROR; // stop on read errors
+                    }
+                    // log event. Do not return, because we do want to handle the next block
+                }
+                in.skip(blockData.available());
+            } break;
+            case BlockType::disposed_block:
+                if (!in.skip(blockSize)) {
+                    return CboxError::PERSISTED_BLOCK_STREAM_ERROR;
+                }
+                break;
+            case BlockType::invalid:
+                return CboxError::INVALID_PERSISTED_BLOCK_TYPE; // unknown block type encountered!
+            default:
+                return CboxError::INVALID_PERSISTED_BLOCK_TYPE; // unknown block type encountered!
+                break;
+            }
+        }
+        return CboxError::OK;
+    }
+
     void
     init()
     {
         uint16_t header;
         eeprom.get(EepromLocation(header), header);
-        if (header != referenceHeader()) {
-            eeprom.clear(); // writes zeros, active groups is now also 0x00
+
+        if (header == referenceHeader(0x01)) {
+            // Version 1 had a fixed layout of 2kb and did not store the length of the objects region.
+            // The block format is unchanged, so the image can be migrated in place.
+            // First write the length, which version 1 ignores, then the new version.
+            objectsLength = stream_size_t(eepromObjectsLegacyLength);
+            eeprom.put(EepromLocation(objectsLength), objectsLength);
             auto referenceHeaderValue = referenceHeader();
             eeprom.put(EepromLocation(header), referenceHeaderValue);
-            resetWriter();
-            // make eeprom one big disposed block
-            writer.put(BlockType::disposed_block);
-            writer.put(uint16_t(EepromLocationSize(objects) - blockHeaderLength()));
+        } else if (header == referenceHeader()) {
+            eeprom.get(EepromLocation(objectsLength), objectsLength);
+        } else {
+            objectsLength = 0; // not a valid image
+        }
+
+        if (objectsLength <= blockHeaderLength()) {
+            format();
+            return;
+        }
+
+        // Version 1 assumed 2kb, but the EEPROM of the Photon and P1 is 1 byte shorter.
+        // Keep the blocks that fit instead of formatting.
+        if (objectsLength > availableObjectsLength()) {
+            shrinkObjectsRegion(availableObjectsLength());
+        }
+
+        // EEPROM can be larger than the objects region when the platform was given more storage
+        if (availableObjectsLength() > objectsLength) {
+            extendObjectsRegion(availableObjectsLength());
+        }
+        eeprom.flush();
+    }
+
+    void
+    format()
+    {
+        eeprom.clear(); // writes zeros, active groups is now also 0x00
+        objectsLength = availableObjectsLength();
+        eeprom.put(EepromLocation(objectsLength), objectsLength);
+        auto referenceHeaderValue = referenceHeader();
+        eeprom.put(EepromLocation(header), referenceHeaderValue);
+        resetWriter();
+        // make eeprom one big disposed block
+        writer.put(BlockType::disposed_block);
+        writer.put(uint16_t(objectsLength - blockHeaderLength()));
+        eeprom.flush();
+    }
+
+    // Grow the objects region in place, by adding a disposed block at the end.
+    void
+    extendObjectsRegion(stream_size_t newLength)
+    {
+        stream_size_t added = newLength - objectsLength;
+        if (added <= blockHeaderLength()) {
+            return; // LCOV_EXCL_LINE: not enough space to add a useful block
+        }
+        // write the new block before updating the length in the header, so the region is valid if power is lost in between
+        writer.reset(eepromObjectsStart + objectsLength, added);
+        writer.put(BlockType::disposed_block);
+        writer.put(uint16_t(added - blockHeaderLength()));
+        objectsLength = newLength;
+        eeprom.put(EepromLocation(objectsLength), objectsLength);
+        mergeDisposedBlocks();
+    }
+
+    // Shrink the objects region in place, by shortening the block that crosses the new end.
+    // Normally this is the disposed block at the end. An object is only kept if its data ends before the new end.
+    void
+    shrinkObjectsRegion(stream_size_t newLength)
+    {
+        eeprom_offset_t end = eepromObjectsStart + newLength;
+        eeprom_offset_t start = eepromObjectsStart;
+        eeprom_offset_t previous = 0;
+        while (start + blockHeaderLength() <= end) {
+            uint8_t type = eeprom.readByte(start);
+            uint16_t blockSize = 0;
+            eeprom.get(start + sizeof(BlockType), blockSize);
+            eeprom_offset_t next = start + blockHeaderLength() + blockSize;
+            if (next > end) {
+                uint16_t usedSize = 0;
+                eeprom.get(start + blockHeaderLength(), usedSize);
+                bool keepObject = type == BlockType::object && start + objectHeaderLength() + usedSize <= end;
+                if (!keepObject) {
+                    eeprom.put(start, BlockType::disposed_block);
+                }
+                eeprom.put(start + sizeof(BlockType), uint16_t(end - start - blockHeaderLength()));
+                next = end;
+            }
+            previous = start;
+            start = next;
+        }
+        if (start < end && previous) {
+            // the remainder is too small for a block header, add it to the last block
+            uint16_t blockSize = 0;
+            eeprom.get(previous + sizeof(BlockType), blockSize);
+            eeprom.put(previous + sizeof(BlockType), uint16_t(blockSize + (end - start)));
         }
+        objectsLength = newLength;
+        eeprom.put(EepromLocation(objectsLength), objectsLength);
     }
 
     // move a single disposed block backwards by swapping it with an object
@@ -501,7 +685,7 @@ private:
         resetReader();
         RegionDataIn disposedBlock = getBlockReader(BlockType::disposed_block);
 
-        uint16_t disposedStart = reader.offset();
+        eeprom_offset_t disposedStart = reader.offset();
         uint16_t disposedLength = disposedBlock.available();
         if (disposedLength == 0) {
             return false;
@@ -546,7 +730,7 @@ private:
         while (reader.hasNext()) {
             RegionDataIn disposedBlock1 = getBlockReader(BlockType::disposed_block);
 
-            uint16_t disposedDataStart1 = reader.offset();
+            eeprom_offset_t disposedDataStart1 = reader.offset();
             uint16_t disposedDataLength1 = disposedBlock1.available();
 
             reader.skip(disposedDataLength1);
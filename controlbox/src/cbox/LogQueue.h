@@ -0,0 +1,183 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "DataStream.h"
+#include "RingBuffer.h"
+#include <cstring>
+
+namespace cbox {
+
+/**
+ * Fixed size queue for log messages and events, which are sent as annotations: <message>.
+ * Messages are queued by the caller without touching any connection and written to connections between replies.
+ *
+ * Each message is stored as a 3 byte header (length, target, repeat count), followed by the message.
+ * A message that is identical to the previous queued message only increments its repeat count.
+ * A message that doesn't fit is dropped. The number of dropped messages is sent as an event on the next drain.
+ */
+template <size_t N>
+class LogQueue {
+public:
+    enum class Target : uint8_t {
+        ALL = 0,     // all connections
+        CURRENT = 1, // the connection that is being processed
+    };
+
+    LogQueue() = default;
+    ~LogQueue() = default;
+
+    /**
+     * Queue a message. The prefix and text are concatenated, long messages are truncated to 255 bytes.
+     * @return false if the message was dropped
+     */
+    bool push(Target target, const char* prefix, const char* text, size_t textLen)
+    {
+        size_t prefixLen = strlen(prefix);
+        size_t len = std::min(prefixLen + textLen, maxMessageLength());
+        prefixLen = std::min(prefixLen, len);
+
+        if (lastValid && isLast(target, prefix, prefixLen, text, len)) {
+            uint8_t& repeats = queue[last + 2];
+            if (repeats < 255) {
+                ++repeats;
+                return true;
+            }
+        }
+
+        if (queue.space() < headerLength() + len) {
+            ++dropped;
+            return false;
+        }
+
+        last = queue.size();
+        lastValid = true;
+        queue.push(uint8_t(len));
+        queue.push(uint8_t(target));
+        queue.push(uint8_t(1));
+        queue.push(reinterpret_cast<const uint8_t*>(prefix), prefixLen);
+        queue.push(reinterpret_cast<const uint8_t*>(text), len - prefixLen);
+        return true;
+    }
+
+    /**
+     * Write all queued messages and empty the queue
+     * @param current: output for messages that were queued with Target::CURRENT
+     * @param all: output for messages that were queued with Target::ALL
+     */
+    void drain(DataOut& current, DataOut& all)
+    {
+        size_t pos = 0;
+        while (pos + headerLength() <= queue.size()) {
+            uint8_t len = queue[pos];
+            DataOut& out = Target(queue[pos + 1]) == Target::CURRENT ? current : all;
+            uint8_t repeats = queue[pos + 2];
+            pos += headerLength();
+
+            out.write('<');
+            for (size_t i = 0; i < len; ++i) {
+                out.write(queue[pos + i]);
+            }
+            if (repeats > 1) {
+                writeString(out, " (repeated ");
+                writeDecimal(out, repeats);
+                writeString(out, " times)");
+            }
+            out.write('>');
+            pos += len;
+        }
+        queue.clear();
+        lastValid = false;
+
+        if (dropped != droppedReported) {
+            writeString(all, "<!Log messages dropped: ");
+            writeDecimal(all, dropped - droppedReported);
+            all.write('>');
+            droppedReported = dropped;
+        }
+    }
+
+    bool empty() const
+    {
+        return queue.empty();
+    }
+
+    // total number of dropped messages
+    uint32_t droppedCount() const
+    {
+        return dropped;
+    }
+
+private:
+    static constexpr size_t headerLength()
+    {
+        return 3;
+    }
+
+    static constexpr size_t maxMessageLength()
+    {
+        return 255;
+    }
+
+    RingBuffer<N> queue;
+    size_t last = 0; // position of the header of the last message
+    bool lastValid = false;
+    uint32_t dropped = 0;
+    uint32_t droppedReported = 0;
+
+    bool isLast(Target target, const char* prefix, size_t prefixLen, const char* text, size_t len) const
+    {
+        if (queue[last] != len || Target(queue[last + 1]) != target) {
+            return false;
+        }
+        size_t start = last + headerLength();
+        for (size_t i = 0; i < prefixLen; ++i) {
+            if (queue[start + i] != uint8_t(prefix[i])) {
+                return false;
+            }
+        }
+        for (size_t i = prefixLen; i < len; ++i) {
+            if (queue[start + i] != uint8_t(text[i - prefixLen])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void writeString(DataOut& out, const char* str)
+    {
+        out.writeBuffer(str, strlen(str));
+    }
+
+    static void writeDecimal(DataOut& out, uint32_t value)
+    {
+        char digits[10];
+        uint8_t n = 0;
+        do {
+            digits[n++] = '0' + value % 10;
+            value /= 10;
+        } while (value);
+        while (n) {
+            out.write(digits[--n]);
+        }
+    }
+};
+
+} // end namespace cbox
@@ -23,7 +23,7 @@
 #include <stdexcept>
 #include <vector>
 
-#if !defined(PLATFORM_ID) || PLATFORM_ID == 3 // check that ID is unique if building for cross platform (tests)
+#if !defined(PLATFORM_ID) || PLATFORM_ID == 3 // check that type and interface IDs are unique if building for cross platform (tests)
 namespace cbox {
 std::vector<uint16_t> allIds;
 
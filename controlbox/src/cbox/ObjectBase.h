@@ -33,18 +33,21 @@ throwIdNotUnique(uint16_t id);
 template <uint16_t id>
 class ObjectBase : public Object {
 public:
-    ObjectBase() = default;
-    virtual ~ObjectBase() = default;
-
-    static obj_type_t staticTypeId()
+    ObjectBase()
     {
 #if !defined(PLATFORM_ID) || PLATFORM_ID == 3 // check that ID is unique if building for cross platform (tests)
+        // ObjectRegistry only checks factory types against each other, this also checks system objects against interfaces
         static auto uniqueId = throwIdNotUnique(id);
-        return uniqueId;
-#else
-        return id;
+        (void)uniqueId;
 #endif
     }
+    virtual ~ObjectBase() = default;
+
+    // uniqueness of object type IDs in the factory is checked at compile time by ObjectRegistry
+    static constexpr obj_type_t staticTypeId()
+    {
+        return id;
+    }
 
     /**
 	 * The application defined typeID for this object instance. Defined by derived class
@@ -90,4 +93,37 @@ interfaceId(typename std::enable_if_t<!std::is_base_of<Object, T>::value>* = 0)
 #endif
 }
 
+namespace detail {
+template <typename... Interfaces>
+struct InterfaceList {
+};
+
+template <typename Source>
+void*
+findInterface(const obj_type_t&, Source&, InterfaceList<>)
+{
+    return nullptr;
+}
+
+template <typename Source, typename Interface, typename... Interfaces>
+void*
+findInterface(const obj_type_t& iface, Source& source, InterfaceList<Interface, Interfaces...>)
+{
+    if (iface == interfaceId<Interface>()) {
+        Interface* ptr = &source; // pointer with the offset of the interface
+        return ptr;
+    }
+    return findInterface(iface, source, InterfaceList<Interfaces...>{});
+}
+} // end namespace detail
+
+// Objects that implement interfaces with a member list them once:
+// findInterface<InterfaceA, InterfaceB>(iface, member) returns the member cast to the requested interface, or nullptr.
+template <typename... Interfaces, typename Source>
+void*
+findInterface(const obj_type_t& iface, Source& source)
+{
+    return detail::findInterface(iface, source, detail::InterfaceList<Interfaces...>{});
+}
+
 } // end namespace cbox
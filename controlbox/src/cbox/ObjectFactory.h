@@ -22,39 +22,102 @@
 
 #include "DataStream.h"
 #include "Object.h"
-#include <functional>
+#include <algorithm>
 #include <memory>
 #include <tuple>
-#include <vector>
+#include <type_traits>
 
 namespace cbox {
 
-// An object factory combines the create function with a type ID.
-// They can be put in a container that can be walked to find the matching typeId
+class ObjectContainer;
+
+// Objects that refer to other objects are constructed with the container that holds them, other objects are default constructed.
 // The container keeps the objects as shared pointer, so it can create weak pointers to them.
 // Therefore the factory creates a shared pointer right away to only have one allocation.
+using ObjectCreateFn = std::shared_ptr<Object> (*)(ObjectContainer& objects);
+
+// An object factory entry combines the create function with a type ID.
 struct ObjectFactoryEntry {
     obj_type_t typeId;
-    std::function<std::shared_ptr<Object>()> createFn;
+    ObjectCreateFn createFn;
+};
+
+namespace detail {
+
+template <typename T>
+std::enable_if_t<std::is_constructible<T, ObjectContainer&>::value, std::shared_ptr<Object>>
+makeObject(ObjectContainer& objects)
+{
+    return std::make_shared<T>(objects);
+}
+
+template <typename T>
+std::enable_if_t<!std::is_constructible<T, ObjectContainer&>::value, std::shared_ptr<Object>>
+makeObject(ObjectContainer&)
+{
+    return std::make_shared<T>();
+}
+
+template <size_t N>
+struct ObjectFactoryTable {
+    ObjectFactoryEntry entries[N];
 };
 
+template <size_t N>
+constexpr ObjectFactoryTable<N>
+sortedByTypeId(ObjectFactoryTable<N> table)
+{
+    for (size_t i = 1; i < N; ++i) {
+        for (size_t j = i; j > 0 && table.entries[j - 1].typeId > table.entries[j].typeId; --j) {
+            auto swapped = table.entries[j];
+            table.entries[j] = table.entries[j - 1];
+            table.entries[j - 1] = swapped;
+        }
+    }
+    return table;
+}
+
+template <size_t N>
+constexpr bool
+typeIdsAreUnique(const ObjectFactoryTable<N>& sorted)
+{
+    for (size_t i = 1; i < N; ++i) {
+        if (sorted.entries[i - 1].typeId == sorted.entries[i].typeId) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // end namespace detail
+
+// Creates objects by type ID from a table of entries that is sorted by type ID, so it can use a binary search.
+// The table is not copied and should outlive the factory. Use ObjectRegistry to generate a sorted table at compile time.
 class ObjectFactory {
 private:
-    const std::vector<ObjectFactoryEntry> objTypes;
+    const ObjectFactoryEntry* first;
+    const ObjectFactoryEntry* last;
 
 public:
-    ObjectFactory(std::initializer_list<ObjectFactoryEntry> _objTypes)
-        : objTypes(_objTypes)
+    constexpr ObjectFactory(const ObjectFactoryEntry* entries, size_t numEntries)
+        : first(entries)
+        , last(entries + numEntries)
     {
     }
 
-    std::tuple<CboxError, std::shared_ptr<Object>> make(const obj_type_t& t) const
+    template <size_t N>
+    constexpr ObjectFactory(const ObjectFactoryEntry (&entries)[N])
+        : ObjectFactory(entries, N)
     {
-        auto factoryEntry = std::find_if(objTypes.begin(), objTypes.end(), [&t](const ObjectFactoryEntry& entry) { return entry.typeId == t; });
-        if (factoryEntry == objTypes.end()) {
+    }
+
+    std::tuple<CboxError, std::shared_ptr<Object>> make(const obj_type_t& t, ObjectContainer& objects) const
+    {
+        auto factoryEntry = std::lower_bound(first, last, t, [](const ObjectFactoryEntry& entry, const obj_type_t& id) { return entry.typeId < id; });
+        if (factoryEntry == last || factoryEntry->typeId != t) {
             return std::make_tuple(CboxError::OBJECT_NOT_CREATABLE, std::shared_ptr<Object>());
         }
-        auto obj = (*factoryEntry).createFn();
+        auto obj = factoryEntry->createFn(objects);
         if (!obj) {
             return std::make_tuple(CboxError::INSUFFICIENT_HEAP, std::shared_ptr<Object>());
         }
@@ -63,4 +126,30 @@ public:
     }
 };
 
+// Each object type is listed once in the registry. The factory table is generated and sorted at compile time,
+// so it can be kept in flash and a duplicate type ID is a compile error.
+// Object types that are not used on a platform are simply left out of the list.
+template <typename... Ts>
+class ObjectRegistry {
+public:
+    static constexpr size_t size()
+    {
+        return sizeof...(Ts);
+    }
+
+    static constexpr detail::ObjectFactoryTable<sizeof...(Ts)> table = detail::sortedByTypeId(
+        detail::ObjectFactoryTable<sizeof...(Ts)>{{ObjectFactoryEntry{Ts::staticTypeId(), &detail::makeObject<Ts>}...}});
+
+    static_assert(sizeof...(Ts) > 0, "Object registry cannot be empty");
+    static_assert(detail::typeIdsAreUnique(table), "Type ID is not unique in object registry");
+
+    static constexpr ObjectFactory factory()
+    {
+        return ObjectFactory(table.entries);
+    }
+};
+
+template <typename... Ts>
+constexpr detail::ObjectFactoryTable<sizeof...(Ts)> ObjectRegistry<Ts...>::table;
+
 } // end namespace cbox
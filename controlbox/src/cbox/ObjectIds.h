@@ -25,11 +25,11 @@ namespace cbox {
 
 class obj_type_t {
 public:
-    obj_type_t()
+    constexpr obj_type_t()
         : id(0)
     {
     }
-    obj_type_t(const uint16_t& rhs)
+    constexpr obj_type_t(const uint16_t& rhs)
         : id(rhs)
     {
     }
@@ -40,7 +40,7 @@ public:
         return *this;
     }
 
-    operator uint16_t() const
+    constexpr operator uint16_t() const
     {
         return id;
     }
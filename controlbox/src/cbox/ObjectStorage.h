@@ -42,6 +42,9 @@ public:
     virtual CboxError retrieveObjects(
         const std::function<CboxError(const storage_id_t& id, RegionDataIn&)>& handler)
         = 0;
+    virtual CboxError retrieveObjectsBuffered(
+        const std::function<CboxError(const storage_id_t& id, RegionDataIn&)>& handler)
+        = 0;
     virtual bool disposeObject(const storage_id_t& id, bool mergeDisposed = true) = 0;
 
     virtual void clear() = 0;
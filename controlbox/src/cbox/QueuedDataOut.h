@@ -0,0 +1,148 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "DataStream.h"
+#include "RingBuffer.h"
+
+namespace cbox {
+
+/**
+ * Counters shared by all queues of a connection source, so they outlive the connections
+ */
+struct QueuedDataOutStats {
+    uint32_t droppedAnnotations = 0; // log messages and events dropped because the client was too slow
+    uint32_t overflows = 0;          // connections closed because output didn't fit in the queue
+    uint32_t maxQueued = 0;          // highest number of bytes waiting to be sent
+
+    bool streamTo(DataOut& out) const
+    {
+        return out.put(droppedAnnotations) && out.put(overflows) && out.put(maxQueued);
+    }
+};
+
+/**
+ * A DataOut that queues output in a fixed size ring and sends it to the stream without blocking.
+ * The stream should provide write(const uint8_t* data, size_t len, timeout), which returns the number of bytes sent.
+ * It is called with a timeout of zero, so it only sends what fits in the send buffer of the stream.
+ *
+ * Output has two priorities:
+ * - Annotations (log messages and events, between '<' and '>') have a low priority.
+ *   An annotation that starts when the queue is more than half full is dropped entirely.
+ * - All other output is a reply to a command. If it doesn't fit, the queue overflows.
+ *   The reply would be corrupted, so the connection should be closed.
+ */
+template <typename T, size_t N>
+class QueuedDataOut final : public DataOut {
+private:
+    T& stream;
+    QueuedDataOutStats& stats;
+    RingBuffer<N> queue;
+    bool dropping = false;
+    bool overflowed = false;
+
+public:
+    QueuedDataOut(T& _stream, QueuedDataOutStats& _stats)
+        : stream(_stream)
+        , stats(_stats)
+    {
+    }
+    virtual ~QueuedDataOut() = default;
+
+    using DataOut::writeBuffer;
+
+    virtual bool write(uint8_t data) override final
+    {
+        if (overflowed) {
+            return false;
+        }
+        if (dropping) {
+            dropping = data != '>';
+            return true;
+        }
+        if (data == '<' && queue.size() >= lowPriorityLimit()) {
+            flush();
+            if (queue.size() >= lowPriorityLimit()) {
+                dropping = true;
+                ++stats.droppedAnnotations;
+                return true;
+            }
+        }
+        if (queue.full()) {
+            flush();
+        }
+        if (!queue.push(data)) {
+            overflowed = true;
+            ++stats.overflows;
+            return false;
+        }
+        stats.maxQueued = std::max(stats.maxQueued, uint32_t(queue.size()));
+        return true;
+    }
+
+    virtual bool writeBuffer(const uint8_t* data, stream_size_t len) override final
+    {
+        for (stream_size_t i = 0; i < len; ++i) {
+            if (!write(data[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Send queued data until the stream doesn't accept more without blocking
+     */
+    void flush()
+    {
+        while (!queue.empty()) {
+            const uint8_t* chunk;
+            size_t len = queue.peek(chunk);
+            size_t sent = stream.write(chunk, len, 0);
+            if (sent > len) {
+                break; // negative error code converted to size_t, retry on next flush
+            }
+            queue.consume(sent);
+            if (sent < len) {
+                break;
+            }
+        }
+    }
+
+    /**
+     * Returns true if reply data was lost because the queue was full
+     */
+    bool hasOverflowed() const
+    {
+        return overflowed;
+    }
+
+    size_t queued() const
+    {
+        return queue.size();
+    }
+
+    static constexpr size_t lowPriorityLimit()
+    {
+        return N / 2;
+    }
+};
+
+} // end namespace cbox
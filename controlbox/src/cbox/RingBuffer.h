@@ -0,0 +1,141 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace cbox {
+
+/**
+ * Fixed capacity FIFO byte queue. It never allocates: when it is full, pushing fails.
+ * Data is read in place: peek() gives the largest contiguous chunk at the front, consume() removes it.
+ */
+template <size_t N>
+class RingBuffer {
+public:
+    RingBuffer() = default;
+    ~RingBuffer() = default;
+
+    static constexpr size_t capacity()
+    {
+        return N;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    size_t space() const
+    {
+        return N - count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    bool full() const
+    {
+        return count == N;
+    }
+
+    bool push(uint8_t value)
+    {
+        if (full()) {
+            return false;
+        }
+        data[head] = value;
+        head = (head + 1) % N;
+        ++count;
+        return true;
+    }
+
+    /**
+     * Push as much of the source as fits
+     * @return number of bytes pushed
+     */
+    size_t push(const uint8_t* source, size_t len)
+    {
+        size_t toPush = std::min(len, space());
+        size_t pushed = 0;
+        while (pushed < toPush) {
+            size_t chunk = std::min(toPush - pushed, N - head);
+            std::copy(source + pushed, source + pushed + chunk, &data[head]);
+            head = (head + chunk) % N;
+            pushed += chunk;
+        }
+        count += pushed;
+        return pushed;
+    }
+
+    /**
+     * Get the longest contiguous chunk of data at the front of the queue, without removing it
+     * @param chunk: set to the start of the chunk
+     * @return length of the chunk
+     */
+    size_t peek(const uint8_t*& chunk) const
+    {
+        chunk = &data[tail];
+        return std::min(count, N - tail);
+    }
+
+    /**
+     * Access queued data by position, 0 being the front of the queue
+     */
+    uint8_t& operator[](size_t pos)
+    {
+        return data[(tail + pos) % N];
+    }
+
+    const uint8_t& operator[](size_t pos) const
+    {
+        return data[(tail + pos) % N];
+    }
+
+    /**
+     * Remove bytes from the front of the queue
+     */
+    void consume(size_t len)
+    {
+        len = std::min(len, count);
+        tail = (tail + len) % N;
+        count -= len;
+    }
+
+    void clear()
+    {
+        head = 0;
+        tail = 0;
+        count = 0;
+    }
+
+private:
+    std::array<uint8_t, N> data;
+    size_t head = 0; // next write position
+    size_t tail = 0; // next read position
+    size_t count = 0;
+};
+
+} // end namespace cbox
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace cbox {
+
+/**
+ * Fixed capacity byte queue that is safe to use without locks by exactly one producer thread and one consumer thread.
+ * The producer only writes head, the consumer only writes tail. Both indexes increase without wrapping,
+ * so the queue can use its full capacity. N must be a power of 2.
+ *
+ * push functions may only be called by the producer, pop and peek functions only by the consumer.
+ * size() and empty() can be called by both, but the result can be outdated immediately.
+ */
+template <size_t N>
+class SpscRingBuffer {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of 2");
+
+public:
+    SpscRingBuffer() = default;
+    ~SpscRingBuffer() = default;
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    static constexpr size_t capacity()
+    {
+        return N;
+    }
+
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    size_t space() const
+    {
+        return N - size();
+    }
+
+    /**
+     * Push as much of the source as fits
+     * @return number of bytes pushed
+     */
+    size_t push(const uint8_t* source, size_t len)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        size_t toPush = std::min(len, N - (h - t));
+        size_t start = h & (N - 1);
+        size_t first = std::min(toPush, N - start);
+        std::copy(source, source + first, &data[start]);
+        std::copy(source + first, source + toPush, &data[0]);
+        head.store(h + toPush, std::memory_order_release); // publish data after it is written
+        return toPush;
+    }
+
+    bool push(uint8_t value)
+    {
+        return push(&value, 1) == 1;
+    }
+
+    /**
+     * Pop up to len bytes into target
+     * @return number of bytes popped
+     */
+    size_t pop(uint8_t* target, size_t len)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        size_t toPop = std::min(len, h - t);
+        size_t start = t & (N - 1);
+        size_t first = std::min(toPop, N - start);
+        std::copy(&data[start], &data[start] + first, target);
+        std::copy(&data[0], &data[0] + (toPop - first), target + first);
+        tail.store(t + toPop, std::memory_order_release); // free space after data is read
+        return toPop;
+    }
+
+    /**
+     * Read the first byte without removing it
+     * @return false if the queue is empty
+     */
+    bool peek(uint8_t& value) const
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) {
+            return false;
+        }
+        value = data[t & (N - 1)];
+        return true;
+    }
+
+    /**
+     * Copy the first len bytes without removing them
+     * @return false if less than len bytes are queued
+     */
+    bool peek(uint8_t* target, size_t len) const
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) - t < len) {
+            return false;
+        }
+        size_t start = t & (N - 1);
+        size_t first = std::min(len, N - start);
+        std::copy(&data[start], &data[start] + first, target);
+        std::copy(&data[0], &data[0] + (len - first), target + first);
+        return true;
+    }
+
+private:
+    std::array<uint8_t, N> data;
+    std::atomic<size_t> head{0}; // total bytes pushed, only written by the producer
+    std::atomic<size_t> tail{0}; // total bytes popped, only written by the consumer
+};
+
+} // end namespace cbox
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "DataStream.h"
+#include "Tracing.h"
+#include <cstring>
+
+namespace cbox {
+namespace tracing {
+
+    namespace detail {
+        inline void writeText(DataOut& out, const char* text)
+        {
+            out.writeBuffer(text, strlen(text));
+        }
+
+        inline void writeDecimal(DataOut& out, uint32_t value)
+        {
+            char digits[10];
+            uint8_t n = 0;
+            do {
+                digits[n++] = '0' + value % 10;
+                value /= 10;
+            } while (value);
+            while (n) {
+                out.write(digits[--n]);
+            }
+        }
+    }
+
+    /**
+     * Write the timeline in binary format: uint16 number of events, followed by the events, oldest first.
+     * Each event is: uint32 start, uint32 duration (both in microseconds), uint8 action, uint16 id, uint16 type.
+     * Events that are overwritten while the timeline is written are sent as all zeros (action NONE).
+     */
+    inline bool streamTimelineTo(DataOut& out)
+    {
+        timeline::Snapshot snapshot;
+        bool success = out.put(uint16_t(snapshot.size()));
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            TimedEvent event{0, 0, 0, 0, 0};
+            snapshot.get(i, event);
+            success = success
+                      && out.put(event.start)
+                      && out.put(event.duration)
+                      && out.put(event.action)
+                      && out.put(event.id)
+                      && out.put(event.type);
+        }
+        return success;
+    }
+
+    /**
+     * Write the timeline in the Chrome trace event format, which can be opened in chrome://tracing or Perfetto.
+     * Each event is a complete event ("ph":"X"). Timestamps are in microseconds since the oldest event.
+     * Events that are overwritten while the timeline is written are left out.
+     * @param name: returns the name of an action, or nullptr to use the action number as name
+     */
+    inline void writeChromeTrace(DataOut& out, const char* (*name)(uint8_t) = actionName)
+    {
+        using detail::writeDecimal;
+        using detail::writeText;
+
+        timeline::Snapshot snapshot;
+        writeText(out, "{\"traceEvents\":[");
+        bool first = true;
+        uint32_t origin = 0;
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            TimedEvent event;
+            if (!snapshot.get(i, event)) {
+                continue;
+            }
+            if (first) {
+                origin = event.start;
+                first = false;
+            } else {
+                out.write(',');
+            }
+            writeText(out, "\n{\"name\":\"");
+            if (const char* actionStr = name(event.action)) {
+                writeText(out, actionStr);
+            } else {
+                writeDecimal(out, event.action);
+            }
+            writeText(out, "\",\"ph\":\"X\",\"ts\":");
+            writeDecimal(out, event.start - origin);
+            writeText(out, ",\"dur\":");
+            writeDecimal(out, event.duration);
+            writeText(out, ",\"pid\":1,\"tid\":1,\"args\":{\"id\":");
+            writeDecimal(out, event.id);
+            writeText(out, ",\"type\":");
+            writeDecimal(out, event.type);
+            writeText(out, "}}");
+        }
+        writeText(out, "\n]}\n");
+    }
+
+} // end namespace tracing
+} // end namespace cbox
@@ -21,50 +21,235 @@
 #include "ObjectIds.h"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
 
 namespace cbox {
 
 namespace tracing {
     namespace detail {
         __attribute__((section(".retained_user"))) std::array<TraceEvent, 10> historyRetained = std::array<TraceEvent, 10>{TraceEvent{uint8_t(tracing::Action::NONE), 0, 0}};
-        __attribute__((section(".retained_user"))) uint8_t lastIdx = 0;
-        bool writeEnabled = false;
+        __attribute__((section(".retained_user"))) std::atomic<uint8_t> lastIdx{0};
+        std::atomic<bool> writeEnabled{false};
+        uint8_t enabledCategories = defaultCategories() & CBOX_TRACE_CATEGORIES;
+
+        // Actions are traced by both the control and the communication thread.
+        // Writers claim an entry by advancing lastIdx, readers retry their copy when an entry was written meanwhile.
+        std::atomic<uint32_t> historyWritesStarted{0};
+        std::atomic<uint32_t> historyWritesDone{0};
+
+        // the entries are plain structs in retained memory, access the fields atomically
+        void storeEvent(TraceEvent& dest, uint8_t a, uint16_t i, uint16_t t)
+        {
+            __atomic_store_n(&dest.action, a, __ATOMIC_RELAXED);
+            __atomic_store_n(&dest.id, i, __ATOMIC_RELAXED);
+            __atomic_store_n(&dest.type, t, __ATOMIC_RELAXED);
+        }
+
+        TraceEvent loadEvent(const TraceEvent& src)
+        {
+            return TraceEvent{
+                __atomic_load_n(&src.action, __ATOMIC_RELAXED),
+                __atomic_load_n(&src.id, __ATOMIC_RELAXED),
+                __atomic_load_n(&src.type, __ATOMIC_RELAXED)};
+        }
     }
 
     void add(uint8_t a, obj_id_t i, obj_type_t t)
     {
         using namespace detail;
-        if (writeEnabled) {
-            if (historyRetained[lastIdx].action == uint8_t(Action::PERSIST_OBJECT) && historyRetained[lastIdx].id == i) {
-                return; // persisting a block can take a retry if a new block needs to be allocated, don't log twice.
+        if (!writeEnabled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        // counted as started before the entry is claimed, so a reader that sees the new lastIdx retries
+        historyWritesStarted.fetch_add(1, std::memory_order_relaxed);
+        uint8_t idx = lastIdx.load(std::memory_order_relaxed);
+        uint8_t next;
+        do {
+            auto last = loadEvent(historyRetained[idx]);
+            if (last.action == uint8_t(Action::PERSIST_OBJECT) && last.id == i) {
+                // persisting a block can take a retry if a new block needs to be allocated, don't log twice.
+                historyWritesDone.fetch_add(1, std::memory_order_release);
+                return;
             }
-            lastIdx = (lastIdx < 9) ? lastIdx + 1 : 0;
+            next = (idx < 9) ? idx + 1 : 0;
+        } while (!lastIdx.compare_exchange_weak(idx, next, std::memory_order_release, std::memory_order_relaxed));
 
-            historyRetained[lastIdx] = TraceEvent{a, i, t};
-        }
+        std::atomic_thread_fence(std::memory_order_release);
+        storeEvent(historyRetained[next], a, i, t);
+        historyWritesDone.fetch_add(1, std::memory_order_release);
     }
 
-    const std::array<TraceEvent, 10>& history()
+    std::array<TraceEvent, 10> history()
     {
-        // history is kept as a circular buffer,
-        // rotate array so oldest element is the first element before returning
+        // history is kept as a circular buffer, copy it with the oldest element first
         using namespace detail;
-        if (lastIdx != 9) {
-            std::rotate(historyRetained.begin(), historyRetained.begin() + lastIdx + 1, historyRetained.end());
-            lastIdx = 9;
-        }
-        return historyRetained;
+        std::array<TraceEvent, 10> result;
+        uint32_t done;
+        uint32_t started;
+        do {
+            done = historyWritesDone.load(std::memory_order_acquire);
+            uint8_t idx = lastIdx.load(std::memory_order_relaxed);
+            for (auto& event : result) {
+                idx = (idx < 9) ? idx + 1 : 0;
+                event = loadEvent(historyRetained[idx]);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            started = historyWritesStarted.load(std::memory_order_relaxed);
+        } while (started != done);
+        return result;
+    }
+
+    void setCategories(uint8_t mask)
+    {
+        detail::enabledCategories = mask & CBOX_TRACE_CATEGORIES;
+    }
+
+    uint8_t categories()
+    {
+        return detail::enabledCategories;
     }
 
     void unpause()
     {
-        detail::writeEnabled = true;
+        detail::writeEnabled.store(true, std::memory_order_relaxed);
     }
 
     void pause()
     {
-        detail::writeEnabled = false;
+        detail::writeEnabled.store(false, std::memory_order_relaxed);
+    }
+
+    const char* actionName(uint8_t a)
+    {
+        switch (Action(a)) {
+        case NONE:
+            return "NONE";
+        case READ_OBJECT:
+            return "READ_OBJECT";
+        case WRITE_OBJECT:
+            return "WRITE_OBJECT";
+        case CREATE_OBJECT:
+            return "CREATE_OBJECT";
+        case DELETE_OBJECT:
+            return "DELETE_OBJECT";
+        case LIST_ACTIVE_OBJECTS:
+            return "LIST_ACTIVE_OBJECTS";
+        case READ_STORED_OBJECT:
+            return "READ_STORED_OBJECT";
+        case LIST_STORED_OBJECTS:
+            return "LIST_STORED_OBJECTS";
+        case CLEAR_OBJECTS:
+            return "CLEAR_OBJECTS";
+        case REBOOT:
+            return "REBOOT";
+        case FACTORY_RESET:
+            return "FACTORY_RESET";
+        case LIST_COMPATIBLE_OBJECTS:
+            return "LIST_COMPATIBLE_OBJECTS";
+        case DISCOVER_NEW_OBJECTS:
+            return "DISCOVER_NEW_OBJECTS";
+        case CONSTRUCT_OBJECT:
+            return "CONSTRUCT_OBJECT";
+        case DESTRUCT_OBJECT:
+            return "DESTRUCT_OBJECT";
+        case STREAM_FROM_OBJECT:
+            return "STREAM_FROM_OBJECT";
+        case STREAM_TO_OBJECT:
+            return "STREAM_TO_OBJECT";
+        case UPDATE_OBJECT:
+            return "UPDATE_OBJECT";
+        case PERSIST_OBJECT:
+            return "PERSIST_OBJECT";
+        case LOAD_STORED_OBJECT:
+            return "LOAD_STORED_OBJECT";
+        case UPDATE_OBJECTS:
+            return "UPDATE_OBJECTS";
+        case UPDATE_CONNECTIONS:
+            return "UPDATE_CONNECTIONS";
+        }
+        return nullptr; // application action
+    }
+
+    namespace timeline {
+        namespace detail {
+            constexpr size_t numWords = (sizeof(TimedEvent) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+            // An entry holds the event with sequence number n when its stamp is 2n + 2. The stamp is odd while it is written.
+            // The event is stored in atomic words, so a reader can copy it while it is overwritten and check the stamp afterwards.
+            struct Entry {
+                std::atomic<uint32_t> stamp{0};
+                std::array<std::atomic<uint32_t>, numWords> words;
+            };
+
+            std::array<Entry, capacity()> entries;
+            std::atomic<uint32_t> recorded{0}; // sequence number of the next event
+            std::atomic<uint32_t> cleared{0};  // sequence number of the first event after the last clear()
+        }
+
+        void record(uint8_t a, obj_id_t i, obj_type_t t, uint32_t start, uint32_t duration)
+        {
+#if CBOX_TIMELINE_SIZE > 0
+            using namespace detail;
+            uint32_t seq = recorded.fetch_add(1, std::memory_order_relaxed);
+            auto& entry = entries[seq % capacity()];
+            uint32_t stamp = entry.stamp.load(std::memory_order_relaxed);
+            if ((stamp & 1) || !entry.stamp.compare_exchange_strong(stamp, 2 * seq + 1, std::memory_order_relaxed)) {
+                return; // another thread still writes an older event to this entry, drop this one
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+
+            auto event = TimedEvent{start, duration, a, i, t};
+            uint32_t buffer[numWords] = {0};
+            memcpy(buffer, &event, sizeof(event));
+            for (size_t w = 0; w < numWords; ++w) {
+                entry.words[w].store(buffer[w], std::memory_order_relaxed);
+            }
+            entry.stamp.store(2 * seq + 2, std::memory_order_release);
+#endif
+        }
+
+        void clear()
+        {
+            detail::cleared.store(detail::recorded.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+        Snapshot::Snapshot()
+        {
+            using namespace detail;
+            end = recorded.load(std::memory_order_acquire);
+            uint32_t count = std::min(end - cleared.load(std::memory_order_relaxed), uint32_t(capacity()));
+            first = end - count;
+        }
+
+        bool Snapshot::get(size_t index, TimedEvent& event) const
+        {
+#if CBOX_TIMELINE_SIZE > 0
+            using namespace detail;
+            if (index >= size()) {
+                return false;
+            }
+            uint32_t seq = first + index;
+            const auto& entry = entries[seq % capacity()];
+            uint32_t stamp = 2 * seq + 2;
+            if (entry.stamp.load(std::memory_order_acquire) != stamp) {
+                return false;
+            }
+            uint32_t buffer[numWords];
+            for (size_t w = 0; w < numWords; ++w) {
+                buffer[w] = entry.words[w].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.stamp.load(std::memory_order_relaxed) != stamp) {
+                return false;
+            }
+            memcpy(&event, buffer, sizeof(event));
+            return true;
+#else
+            return false;
+#endif
+        }
     }
 }
 }
\ No newline at end of file
@@ -20,11 +20,27 @@
 #pragma once
 #include "ObjectIds.h"
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 // allow aplication to define custom actions
 
+// trace categories that are compiled in. Trace points in other categories compile to nothing
+#ifndef CBOX_TRACE_CATEGORIES
+#define CBOX_TRACE_CATEGORIES 0xFF
+#endif
+
+// number of events in the timeline, 0 disables it. Must be a power of 2
+#ifndef CBOX_TIMELINE_SIZE
+#define CBOX_TIMELINE_SIZE 64
+#endif
+
 namespace cbox {
 
+// microsecond clock, provided by the application. It is allowed to wrap.
+uint32_t
+clockMicros();
+
 namespace tracing {
     enum Action : uint8_t {
         NONE = 0,
@@ -54,6 +70,21 @@ namespace tracing {
         UPDATE_CONNECTIONS = 28,
     };
 
+    enum Category : uint8_t {
+        COMMANDS = 1 << 0,       // commands received by the box
+        OBJECT_UPDATES = 1 << 1, // updates and streams of a single object, traced for every object, every tick
+        OBJECT_STORAGE = 1 << 2, // construction, destruction, loading and persisting of objects
+        SYSTEM = 1 << 3,         // updating all objects and connections
+        APPLICATION = 1 << 4,    // actions defined by the application
+        ALL_CATEGORIES = 0xFF,
+    };
+
+    // per object updates are frequent and rarely needed, so they are not traced by default
+    constexpr uint8_t defaultCategories()
+    {
+        return ALL_CATEGORIES & ~OBJECT_UPDATES;
+    }
+
     struct TraceEvent {
         uint8_t action;
         // use raw uint16_t id's, using cbox id's overwrites backup memory on construction somewhere
@@ -67,10 +98,122 @@ namespace tracing {
         add(a, 0, 0);
     }
 
-    const std::array<TraceEvent, 10>& history();
+    namespace detail {
+        extern uint8_t enabledCategories;
+    }
+
+    // set the categories that are traced at runtime, only categories in CBOX_TRACE_CATEGORIES can be enabled
+    void setCategories(uint8_t mask);
+
+    uint8_t categories();
+
+    template <uint8_t category>
+    inline bool enabled()
+    {
+        return (CBOX_TRACE_CATEGORIES & category) && (detail::enabledCategories & category);
+    }
+
+    // adds an action to the history if its category is enabled, without touching the history otherwise
+    template <uint8_t category>
+    inline void add(uint8_t a, obj_id_t i = 0, obj_type_t t = 0)
+    {
+        if (enabled<category>()) {
+            add(a, i, t);
+        }
+    }
+
+    // copy of the crash history, oldest first
+    std::array<TraceEvent, 10> history();
 
     void unpause();
 
     void pause();
+
+    const char* actionName(uint8_t a);
+
+    struct TimedEvent {
+        uint32_t start; // clockMicros() at the start of the action
+        uint32_t duration;
+        uint8_t action;
+        uint16_t id;
+        uint16_t type;
+    };
+
+    /**
+     * The timeline records the start time and duration of actions traced with a Scope.
+     * It is not retained and not paused like the crash history, it always holds the most recent events.
+     * Actions can be recorded by multiple threads without locking. Readers copy the events out with a Snapshot.
+     */
+    namespace timeline {
+        void record(uint8_t a, obj_id_t i, obj_type_t t, uint32_t start, uint32_t duration);
+
+        constexpr size_t capacity()
+        {
+            return CBOX_TIMELINE_SIZE;
+        }
+
+        static_assert((capacity() & (capacity() - 1)) == 0, "CBOX_TIMELINE_SIZE must be a power of 2");
+
+        void clear();
+
+        /**
+         * The events that were in the timeline when the snapshot was taken.
+         * An event is not returned when it was overwritten by a newer event after the snapshot was taken,
+         * or when it was still being recorded.
+         */
+        class Snapshot {
+        public:
+            Snapshot();
+
+            size_t size() const
+            {
+                return end - first;
+            }
+
+            // copy an event by index, 0 being the oldest. Returns false if the event is no longer available
+            bool get(size_t index, TimedEvent& event) const;
+
+        private:
+            uint32_t first; // sequence number of the oldest event
+            uint32_t end;   // sequence number of the next event
+        };
+    }
+
+    /**
+     * Traces an action when it starts, like add(), and records its duration in the timeline when it goes out of scope.
+     * Nothing is traced or timed when the category is disabled.
+     */
+    template <uint8_t category>
+    class Scope {
+    public:
+        explicit Scope(uint8_t a, obj_id_t i = 0, obj_type_t t = 0)
+            : action(a)
+            , id(i)
+            , type(t)
+            , active(enabled<category>())
+            , start(active ? clockMicros() : 0)
+        {
+            if (active) {
+                add(a, i, t);
+            }
+        }
+
+        ~Scope()
+        {
+            if (active) {
+                timeline::record(action, id, type, start, clockMicros() - start);
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        uint8_t action;
+        obj_id_t id;
+        obj_type_t type;
+        bool active;
+        uint32_t start;
+    };
 }
 }
\ No newline at end of file
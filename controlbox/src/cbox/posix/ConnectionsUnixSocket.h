@@ -0,0 +1,255 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../Connections.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace cbox {
+
+/**
+ * A non-blocking Unix domain socket with the part of the Stream interface that is used by the connection templates.
+ * Input is read from the socket in chunks into a small buffer, so single byte reads don't each need a system call.
+ * The stream owns the file descriptor and closes it when it is destroyed.
+ */
+class UnixSocketStream {
+private:
+    int fd = -1;
+    uint8_t inBuffer[256];
+    uint16_t inPos = 0;
+    uint16_t inLen = 0;
+
+public:
+    explicit UnixSocketStream(int _fd)
+        : fd(_fd)
+    {
+    }
+
+    UnixSocketStream(UnixSocketStream&& other)
+        : fd(other.fd)
+        , inPos(other.inPos)
+        , inLen(other.inLen)
+    {
+        std::copy(other.inBuffer + inPos, other.inBuffer + inLen, inBuffer + inPos);
+        other.fd = -1;
+    }
+
+    ~UnixSocketStream()
+    {
+        stop();
+    }
+
+    UnixSocketStream(const UnixSocketStream&) = delete;
+    UnixSocketStream& operator=(const UnixSocketStream&) = delete;
+
+    bool status() const
+    {
+        return fd >= 0;
+    }
+
+    explicit operator bool() const
+    {
+        return status();
+    }
+
+    void stop()
+    {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    int available()
+    {
+        if (inPos == inLen && fd >= 0) {
+            inPos = 0;
+            inLen = 0;
+            ssize_t received = recv(fd, inBuffer, sizeof(inBuffer), 0);
+            if (received > 0) {
+                inLen = uint16_t(received);
+            } else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                stop(); // closed by peer
+            }
+        }
+        return inLen - inPos;
+    }
+
+    int read()
+    {
+        if (available()) {
+            return inBuffer[inPos++];
+        }
+        return -1;
+    }
+
+    int peek()
+    {
+        if (available()) {
+            return inBuffer[inPos];
+        }
+        return -1;
+    }
+
+    /**
+     * Send as much data as the socket accepts without blocking. The timeout is ignored.
+     * @return number of bytes sent
+     */
+    size_t write(const uint8_t* data, size_t len, int /*timeout*/)
+    {
+        if (fd < 0) {
+            return 0;
+        }
+        ssize_t sent = send(fd, data, len, MSG_NOSIGNAL);
+        if (sent >= 0) {
+            return size_t(sent);
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            stop(); // LCOV_EXCL_LINE
+        }
+        return 0;
+    }
+
+    size_t write(const uint8_t* data, size_t len)
+    {
+        return write(data, len, 0);
+    }
+
+    size_t write(uint8_t data)
+    {
+        return write(&data, 1, 0);
+    }
+};
+
+template <>
+inline StreamType
+StreamDataIn<UnixSocketStream>::streamTypeImpl()
+{
+    return StreamType::Unix;
+}
+
+class UnixSocketConnection : public QueuedStreamConnection<UnixSocketStream, 8192> {
+public:
+    UnixSocketConnection(UnixSocketStream&& _stream, QueuedDataOutStats& stats)
+        : QueuedStreamConnection<UnixSocketStream, 8192>(std::move(_stream), stats)
+    {
+    }
+    virtual ~UnixSocketConnection() = default;
+
+    virtual void stop() override final
+    {
+        get().stop();
+    }
+};
+
+/**
+ * Accepts connections on a Unix domain socket. Used by the simulator, so local tools don't need a TCP port.
+ * Each simulator can use its own socket path, which avoids port conflicts when multiple simulators run on one host.
+ * An existing file at the path is removed when the source is started, the socket file is removed when it is stopped.
+ */
+class UnixSocketConnectionSource : public ConnectionSource {
+private:
+    std::string path;
+    int listenFd = -1;
+    QueuedDataOutStats sharedQueueStats;
+
+public:
+    explicit UnixSocketConnectionSource(std::string _path)
+        : path(std::move(_path))
+    {
+    }
+
+    virtual ~UnixSocketConnectionSource()
+    {
+        stop();
+    }
+
+    std::unique_ptr<Connection> newConnection() override final
+    {
+        if (listenFd >= 0) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd >= 0) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                return std::make_unique<UnixSocketConnection>(UnixSocketStream(fd), sharedQueueStats);
+            }
+        }
+        return std::unique_ptr<Connection>();
+    }
+
+    virtual void start() override final
+    {
+        if (listenFd >= 0) {
+            return;
+        }
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            return; // LCOV_EXCL_LINE
+        }
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return; // LCOV_EXCL_LINE
+        }
+        unlink(path.c_str()); // socket file left behind by a previous run
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || listen(fd, 4) != 0) {
+            close(fd); // LCOV_EXCL_LINE
+            return;    // LCOV_EXCL_LINE
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        listenFd = fd;
+    }
+
+    virtual void stop() override final
+    {
+        if (listenFd >= 0) {
+            close(listenFd);
+            listenFd = -1;
+            unlink(path.c_str());
+        }
+    }
+
+    bool listening() const
+    {
+        return listenFd >= 0;
+    }
+
+    virtual uint32_t queueCapacity() const override final
+    {
+        return UnixSocketConnection::queueCapacity();
+    }
+
+    // dropped messages and closed connections of all socket connections since start
+    virtual const QueuedDataOutStats* queueStats() const override final
+    {
+        return &sharedQueueStats;
+    }
+};
+
+} // end namespace cbox
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../EepromAccess.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cbox {
+
+/**
+ * Emulate eeprom with a memory mapped file. Used by the simulator.
+ * Reads and writes are plain memory accesses. Because the mapping is shared, the OS writes changes to the file,
+ * also when the process crashes. flush() synchronizes the file to disk with msync.
+ * The file is grown to the requested size, but never shrunk.
+ */
+class MmapEepromAccess : public EepromAccess {
+public:
+    MmapEepromAccess(const char* path, eeprom_offset_t size)
+    {
+        int fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            return; // LCOV_EXCL_LINE
+        }
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == 0) {
+            created = fileStat.st_size == 0;
+            eeprom_offset_t fileSize = std::max(eeprom_offset_t(fileStat.st_size), size);
+            // a file that is grown reads as zeros, which storage treats as unformatted
+            if (ftruncate(fd, fileSize) == 0) {
+                void* mapped = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (mapped != MAP_FAILED) {
+                    data = static_cast<uint8_t*>(mapped);
+                    _length = fileSize;
+                }
+            }
+        }
+        close(fd); // the mapping keeps a reference to the file
+    }
+
+    virtual ~MmapEepromAccess()
+    {
+        if (data) {
+            msync(data, _length, MS_SYNC);
+            munmap(data, _length);
+        }
+    }
+
+    MmapEepromAccess(const MmapEepromAccess&) = delete;
+    MmapEepromAccess& operator=(const MmapEepromAccess&) = delete;
+
+    /**
+     * Returns true if the file was successfully mapped to memory
+     */
+    bool isMapped() const
+    {
+        return data != nullptr;
+    }
+
+    /**
+     * Returns true if the file did not exist or was empty before it was opened
+     */
+    bool isNew() const
+    {
+        return created;
+    }
+
+    virtual uint8_t readByte(eeprom_offset_t offset) const override final
+    {
+        if (isValidRange(offset, 1))
+            return data[offset];
+        return 0;
+    }
+
+    virtual void writeByte(eeprom_offset_t offset, uint8_t value) override final
+    {
+        if (isValidRange(offset, 1)) {
+            data[offset] = value;
+        }
+    }
+
+    virtual void readBlock(uint8_t* target, eeprom_offset_t offset, eeprom_offset_t size) const override final
+    {
+        if (isValidRange(offset, size))
+            memcpy(target, &data[offset], size);
+    }
+
+    virtual void writeBlock(eeprom_offset_t offset, const uint8_t* source, eeprom_offset_t size) override final
+    {
+        if (isValidRange(offset, size)) {
+            memcpy(&data[offset], source, size);
+        }
+    }
+
+    virtual eeprom_offset_t length() const override final
+    {
+        return _length;
+    }
+
+    virtual void clear() override final
+    {
+        if (data) {
+            memset(data, 0, _length);
+            flush();
+        }
+    }
+
+    virtual void flush() override final
+    {
+        if (data) {
+            msync(data, _length, MS_SYNC);
+        }
+    }
+
+private:
+    bool isValidRange(eeprom_offset_t offset, eeprom_offset_t size) const
+    {
+        return offset < _length && size <= _length && offset + size <= _length;
+    }
+
+    uint8_t* data = nullptr;
+    eeprom_offset_t _length = 0;
+    bool created = false;
+};
+
+} // end namespace cbox
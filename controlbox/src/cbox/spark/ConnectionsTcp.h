@@ -26,10 +26,12 @@
 
 namespace cbox {
 
-class TcpConnection : public StreamConnection<TCPClient> {
+// Output is queued and sent without blocking, so a slow client cannot stall the main loop.
+// The queue only holds what the socket send buffer doesn't accept directly.
+class TcpConnection : public QueuedStreamConnection<TCPClient, 2048> {
 public:
-    explicit TcpConnection(TCPClient&& _client)
-        : StreamConnection<TCPClient>(std::move(_client))
+    TcpConnection(TCPClient&& _client, QueuedDataOutStats& stats)
+        : QueuedStreamConnection<TCPClient, 2048>(std::move(_client), stats)
     {
     }
     virtual ~TcpConnection() = default;
@@ -45,6 +47,7 @@ private:
     TCPServer server;
     bool server_started = false;
     bool server_enabled = false;
+    QueuedDataOutStats sharedQueueStats;
 
 public:
     TcpConnectionSource(uint16_t port)
@@ -62,8 +65,7 @@ public:
 
             TCPClient newClient = server.available();
             if (newClient) {
-                newClient.setTimeout(100);
-                return std::make_unique<TcpConnection>(std::move(newClient));
+                return std::make_unique<TcpConnection>(std::move(newClient), sharedQueueStats);
             }
         } else {
             stop();
@@ -82,6 +84,17 @@ public:
         server_enabled = true;
         server.begin();
     }
+
+    virtual uint32_t queueCapacity() const override final
+    {
+        return TcpConnection::queueCapacity();
+    }
+
+    // dropped messages and closed connections of all TCP connections since boot
+    virtual const QueuedDataOutStats* queueStats() const override final
+    {
+        return &sharedQueueStats;
+    }
 };
 
 } // end namespace cbox
@@ -13,24 +13,24 @@ public:
     }
     virtual ~SparkEepromAccess() = default;
 
-    virtual uint8_t readByte(uint16_t offset) const override final
+    virtual uint8_t readByte(eeprom_offset_t offset) const override final
     {
         return HAL_EEPROM_Read(offset);
     }
-    virtual void writeByte(uint16_t offset, uint8_t value) override final
+    virtual void writeByte(eeprom_offset_t offset, uint8_t value) override final
     {
         HAL_EEPROM_Write(offset, value);
     }
 
-    virtual void readBlock(uint8_t* target, uint16_t offset, uint16_t size) const override final
+    virtual void readBlock(uint8_t* target, eeprom_offset_t offset, eeprom_offset_t size) const override final
     {
         HAL_EEPROM_Get(offset, target, size);
     }
-    virtual void writeBlock(uint16_t target, const uint8_t* source, uint16_t size) override final
+    virtual void writeBlock(eeprom_offset_t target, const uint8_t* source, eeprom_offset_t size) override final
     {
         HAL_EEPROM_Put(target, source, size);
     }
-    virtual uint16_t length() const override final
+    virtual eeprom_offset_t length() const override final
     {
         return HAL_EEPROM_Length();
     }
@@ -39,6 +39,11 @@ public:
     {
         HAL_EEPROM_Clear();
     }
+
+    virtual void flush() override final
+    {
+        // HAL writes to flash directly
+    }
 };
 
 } // end namespace cbox
@@ -119,6 +119,12 @@ StdIO::read()
     return in.next();
 }
 
+size_t
+StdIO::readBytes(char* buffer, size_t length)
+{
+    return in.readBuffer(reinterpret_cast<uint8_t*>(buffer), length);
+}
+
 void
 StdIO::flush()
 {
@@ -1,11 +1,13 @@
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <iostream>
-#include <queue>
 #include <string>
 #include <thread>
 
 #include "../Connections.h"
 #include "../DataStream.h"
+#include "../SpscRingBuffer.h"
 
 namespace cbox {
 
@@ -14,11 +16,14 @@ class Stream {
 
 // trying to peek from stdio is problematic
 // it is much simpler to run a daemon thread that pulls data as it's available.
+// The thread hands data to the main loop through a lock-free single producer, single consumer ring.
+// When the ring is full, the thread waits until the main loop has read data.
 
 class InputStreamPoll : public DataIn {
     std::istream& in;
-    std::thread thread;
-    std::queue<uint8_t> queue;
+    SpscRingBuffer<4096> queue;
+    std::atomic<bool> done{false};
+    std::thread thread; // started last, because it uses the members above
 
 public:
     InputStreamPoll(std::istream& in_)
@@ -32,33 +37,63 @@ public:
         // make it a daemon thread
         thread.detach();
 
-        while (!in.eof()) {
+        uint8_t buffer[256];
+        while (true) {
+            // block for 1 character, then take what is already buffered without blocking
             char c;
-            in.get(c);
-            queue.push(uint8_t(c));
+            if (!in.get(c)) {
+                break;
+            }
+            buffer[0] = uint8_t(c);
+            size_t len = 1 + size_t(in.readsome(reinterpret_cast<char*>(buffer + 1), sizeof(buffer) - 1));
+
+            size_t pushed = 0;
+            while (pushed < len) {
+                pushed += queue.push(buffer + pushed, len - pushed);
+                if (pushed < len) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
         }
+        done = true;
     }
 
     virtual stream_size_t available() override final
     {
-        return queue.size() > 0;
+        return queue.size();
     }
 
     virtual bool hasNext() override final
     {
-        return !in.eof();
+        return !done || !queue.empty();
     }
 
     virtual uint8_t next() override final
     {
-        uint8_t front = peek();
-        queue.pop();
-        return front;
+        uint8_t value = 0;
+        queue.pop(&value, 1);
+        return value;
     }
 
     virtual uint8_t peek() override final
     {
-        return queue.front();
+        uint8_t value = 0;
+        queue.peek(value);
+        return value;
+    }
+
+    /**
+     * Read up to len available bytes at once
+     * @return number of bytes read
+     */
+    stream_size_t readBuffer(uint8_t* target, stream_size_t len)
+    {
+        return queue.pop(target, len);
+    }
+
+    virtual StreamType streamType() const override final
+    {
+        return StreamType::Mock;
     }
 };
 
@@ -75,6 +110,7 @@ public:
 
     int read();
     int peek();
+    size_t readBytes(char* buffer, size_t length);
 
     size_t write(uint8_t w);
     size_t write(const uint8_t* data, uint8_t len)
@@ -31,16 +31,13 @@ SCENARIO("A controlbox Box")
     ArrayEepromAccess<2048> eeprom;
     EepromObjectStorage storage(eeprom);
 
-    ObjectFactory factory = {
-        {LongIntObject::staticTypeId(), std::make_shared<LongIntObject>},
-        {LongIntVectorObject::staticTypeId(), std::make_shared<LongIntVectorObject>},
-        {UpdateCounter::staticTypeId(), std::make_shared<UpdateCounter>},
-        {PtrLongIntObject::staticTypeId(), [&container]() {
-             return std::make_shared<PtrLongIntObject>(container);
-         }},
-        {NameableLongIntObject::staticTypeId(), std::make_shared<NameableLongIntObject>},
-        {MockStreamObject::staticTypeId(), std::make_shared<MockStreamObject>},
-    };
+    ObjectFactory factory = ObjectRegistry<
+        LongIntObject,
+        LongIntVectorObject,
+        UpdateCounter,
+        PtrLongIntObject,
+        NameableLongIntObject,
+        MockStreamObject>::factory();
 
     StringStreamConnectionSource connSource;
     ConnectionPool connPool = {connSource};
@@ -82,6 +79,73 @@ SCENARIO("A controlbox Box")
         CHECK(out->str() == expected.str());
     }
 
+    WHEN("Two read object commands are processed")
+    {
+        *in << "0000010200"; // read object 2
+        *in << crc("0000010200") << "\n";
+        *in << "0000010200";
+        *in << crc("0000010200") << "\n";
+        box.hexCommunicate();
+
+        uint8_t buffer[1000] = {0};
+        BufferDataOut statsOut(buffer, sizeof(buffer));
+        CHECK(box.streamStatsTo(statsOut));
+        BufferDataIn statsIn(buffer, statsOut.bytesWritten());
+
+        auto getU32 = [&statsIn]() {
+            uint32_t v = 0;
+            statsIn.get(v);
+            return v;
+        };
+
+        THEN("The statistics for the read command count both commands, with the bytes sent and received")
+        {
+            CHECK(statsIn.next() == 14); // number of command types
+            statsIn.skip(44);            // skip stats of command 0
+            CHECK(getU32() == 2);        // count
+            CHECK(getU32() == 26);       // bytes in, 13 per command
+            CHECK(getU32() == uint32_t(out->str().size()));
+            getU32();                            // total duration
+            getU32();                            // max duration
+            CHECK(getU32() + getU32() <= 2);     // latency histogram, commands are fast
+            statsIn.skip(4 * 4 + 12 * 44); // skip remaining histogram and other commands
+
+            AND_THEN("The statistics of the connection count the bytes of both commands")
+            {
+                CHECK(statsIn.next() == 1);                         // number of connections
+                CHECK(statsIn.next() == uint8_t(StreamType::Mock)); // connection type
+                CHECK(getU32() == 0);                               // queued bytes
+                CHECK(getU32() == 1);                               // both commands were handled in one call
+                CHECK(getU32() == 26);
+                CHECK(getU32() == uint32_t(out->str().size()));
+                statsIn.skip(8 * 4); // skip durations and histogram
+                CHECK(getU32() == 0); // dropped log messages
+
+                AND_THEN("The output queue statistics of the connection source are reported")
+                {
+                    CHECK(statsIn.next() == 1); // number of connection sources
+                    CHECK(getU32() == 0);       // queue capacity, output of a string stream is not queued
+                    CHECK(getU32() == 0);       // dropped annotations
+                    CHECK(getU32() == 0);       // overflows
+                    CHECK(getU32() == 0);       // max queued
+                    CHECK(statsIn.available() == 0);
+                }
+            }
+        }
+
+        THEN("The statistics can be reset")
+        {
+            box.resetStats();
+            statsOut.reset();
+            box.streamStatsTo(statsOut);
+            BufferDataIn resetIn(buffer, statsOut.bytesWritten());
+            resetIn.skip(1 + 44);
+            uint32_t count = 1;
+            resetIn.get(count);
+            CHECK(count == 0);
+        }
+    }
+
     WHEN("A connection sends a read object command for a non-existing object, INVALID_OBJECT_ID is returned")
     {
         *in << "0000010800"; // read object 8
@@ -647,13 +711,11 @@ SCENARIO("A controlbox Box")
                         ContainedObject(3, 0x80, std::make_shared<LongIntObject>(0x22222222))};
 
                     EepromObjectStorage storage2(eeprom);
-                    ObjectFactory factory2 = {
-                        {LongIntObject::staticTypeId(), std::make_shared<LongIntObject>},
-                        {LongIntVectorObject::staticTypeId(), std::make_shared<LongIntVectorObject>},
-                        {UpdateCounter::staticTypeId(), std::make_shared<UpdateCounter>},
-                        {PtrLongIntObject::staticTypeId(), [&container]() {
-                             return std::make_shared<PtrLongIntObject>(container);
-                         }}};
+                    ObjectFactory factory2 = ObjectRegistry<
+                        LongIntObject,
+                        LongIntVectorObject,
+                        UpdateCounter,
+                        PtrLongIntObject>::factory();
 
                     StringStreamConnectionSource connSource2;
                     ConnectionPool connPool2 = {connSource2};
@@ -946,6 +1008,7 @@ SCENARIO("A controlbox Box")
     THEN("Objects update at their requested interval")
     {
         cbox::tracing::unpause();
+        cbox::tracing::setCategories(cbox::tracing::ALL_CATEGORIES);
         box.update(0);
         // create 2 counter objects with different update intervals
         // object creation and write also triggers an object update
@@ -993,7 +1056,8 @@ SCENARIO("A controlbox Box")
         THEN("Last actions performed on objects are traced")
         {
 
-            auto it = cbox::tracing::history().cbegin();
+            auto history = cbox::tracing::history();
+            auto it = history.cbegin();
 
             CHECK(it->action == cbox::tracing::Action::UPDATE_OBJECT);
             CHECK(it->id == 2);
@@ -1035,6 +1099,7 @@ SCENARIO("A controlbox Box")
             CHECK(it->id == 101);
             CHECK(it->type == 1002);
         }
+        cbox::tracing::setCategories(cbox::tracing::defaultCategories());
 
         auto counterObjPtr1 = box.getObject(100).lock();
         auto counterObjPtr2 = box.getObject(101).lock();
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CommandQueue.h"
+
+#include "ArrayEepromAccess.h"
+#include "ConnectionsStringStream.h"
+#include "DataStreamConverters.h"
+#include "EepromObjectStorage.h"
+#include "TestObjects.h"
+#include <catch.hpp>
+#include <thread>
+
+using namespace cbox;
+
+SCENARIO("Commands can be executed on another thread than the one that handles connections")
+{
+    ObjectContainer container{
+        ContainedObject(2, 0x80, std::make_shared<LongIntObject>(0x11111111)),
+        ContainedObject(3, 0x80, std::make_shared<LongIntObject>(0x22222222))};
+
+    ArrayEepromAccess<2048> eeprom;
+    EepromObjectStorage storage(eeprom);
+    ObjectFactory factory = ObjectRegistry<LongIntObject>::factory();
+
+    StringStreamConnectionSource connSource;
+    ConnectionPool connPool = {connSource};
+    Box box(factory, container, storage, connPool);
+    CommandQueue<256, 256> queue(box, connPool);
+
+    auto in = std::make_shared<std::stringstream>();
+    auto out = std::make_shared<std::stringstream>();
+    connSource.add(in, out);
+
+    const std::string readRequest = addCrc("0000010200");
+    const std::string readReply = readRequest + "|" + addCrc("00020080E80311111111") + "\n";
+
+    auto readCount = [&box]() {
+        uint8_t buffer[1000] = {0};
+        BufferDataOut statsOut(buffer, sizeof(buffer));
+        box.streamStatsTo(statsOut);
+        BufferDataIn statsIn(buffer, statsOut.bytesWritten());
+        statsIn.skip(1 + 44); // number of commands, stats of command 0
+        uint32_t count = 0;
+        statsIn.get(count);
+        return count;
+    };
+
+    WHEN("A partial request is received")
+    {
+        *in << readRequest.substr(0, 6);
+        queue.receive();
+        queue.execute();
+        queue.receive();
+
+        THEN("It is not executed until the line is complete")
+        {
+            CHECK(readCount() == 0);
+            CHECK(out->str() == "");
+
+            *in << readRequest.substr(6) << "\n";
+            queue.receive();
+            queue.execute();
+            queue.receive();
+            CHECK(readCount() == 1);
+            CHECK(out->str() == readReply);
+        }
+    }
+
+    WHEN("More requests are received than fit in the request queue")
+    {
+        for (int i = 0; i < 20; i++) {
+            *in << readRequest << "\n";
+        }
+        queue.receive();
+        queue.execute();
+
+        THEN("The remaining requests are read and executed later, without dropping any")
+        {
+            CHECK(readCount() < 20);
+            while (readCount() < 20) {
+                queue.receive();
+                queue.execute();
+            }
+            queue.receive();
+
+            std::string expected;
+            for (int i = 0; i < 20; i++) {
+                expected += readReply;
+            }
+            CHECK(out->str() == expected);
+            CHECK(queue.droppedRequests() == 0);
+        }
+    }
+
+    WHEN("A request is longer than half the request queue")
+    {
+        *in << std::string(200, '0') << "\n"
+            << readRequest << "\n";
+        queue.receive();
+        queue.execute();
+        queue.receive();
+
+        THEN("It is dropped and the next request is handled")
+        {
+            CHECK(queue.droppedRequests() == 1);
+            CHECK(out->str() == readReply);
+        }
+    }
+
+    WHEN("A message is logged on the control thread outside of a command")
+    {
+        queue.receive(); // accept connection
+        connPool.log("INFO:", "test", 4);
+        queue.execute();
+        queue.receive();
+
+        THEN("It is sent to all connections")
+        {
+            CHECK(out->str() == "<INFO:test>");
+        }
+    }
+
+    WHEN("Connections are handled by another thread")
+    {
+        for (int i = 0; i < 10; i++) {
+            *in << readRequest << "\n";
+        }
+
+        std::atomic<bool> done{false};
+        std::thread commsThread([&queue, &done]() {
+            while (!done) {
+                queue.receive();
+                std::this_thread::yield();
+            }
+        });
+        while (readCount() < 10) {
+            queue.execute();
+            std::this_thread::yield();
+        }
+        done = true;
+        commsThread.join();
+        queue.receive(); // send the last replies
+
+        THEN("All requests are executed on this thread and the replies are sent in order")
+        {
+            std::string expected;
+            for (int i = 0; i < 10; i++) {
+                expected += readReply;
+            }
+            CHECK(out->str() == expected);
+        }
+    }
+}
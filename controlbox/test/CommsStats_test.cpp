@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CommsStats.h"
+#include <catch.hpp>
+
+using namespace cbox;
+
+SCENARIO("Traffic statistics keep a latency histogram with decade buckets")
+{
+    TrafficStats stats;
+
+    THEN("Durations are sorted in buckets starting at 100 microseconds")
+    {
+        CHECK(TrafficStats::bucket(0) == 0);
+        CHECK(TrafficStats::bucket(99) == 0);
+        CHECK(TrafficStats::bucket(100) == 1);
+        CHECK(TrafficStats::bucket(999) == 1);
+        CHECK(TrafficStats::bucket(1000) == 2);
+        CHECK(TrafficStats::bucket(99999) == 3);
+        CHECK(TrafficStats::bucket(999999) == 4);
+        CHECK(TrafficStats::bucket(1000000) == 5);
+        CHECK(TrafficStats::bucket(0xFFFFFFFF) == 5);
+    }
+
+    WHEN("Traffic is added")
+    {
+        stats.add(10, 20, 50);
+        stats.add(5, 100, 5000);
+
+        THEN("Totals, maximum and histogram are updated")
+        {
+            CHECK(stats.count == 2);
+            CHECK(stats.bytesIn == 15);
+            CHECK(stats.bytesOut == 120);
+            CHECK(stats.totalMicros == 5050);
+            CHECK(stats.maxMicros == 5000);
+            CHECK(stats.histogram[0] == 1);
+            CHECK(stats.histogram[2] == 1);
+        }
+
+        THEN("They are streamed as 11 uint32 values")
+        {
+            CountingBlackholeDataOut counter;
+            CHECK(stats.streamTo(counter));
+            CHECK(counter.count() == 44);
+        }
+    }
+
+    WHEN("A reply is larger than the maximum size of a single stream write")
+    {
+        BlackholeDataOut blackhole;
+        CountingDataOut counting(blackhole);
+        uint8_t chunk[1000] = {0};
+        for (uint8_t i = 0; i < 100; i++) {
+            counting.writeBuffer(chunk, sizeof(chunk));
+        }
+        stats.add(0, counting.count(), 50);
+
+        THEN("The bytes are counted without wrapping")
+        {
+            CHECK(counting.count() == 100000);
+            CHECK(stats.bytesOut == 100000);
+        }
+    }
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "posix/ConnectionsUnixSocket.h"
+
+#include <catch.hpp>
+#include <string>
+#include <sys/stat.h>
+
+using namespace cbox;
+
+namespace {
+int
+connectClient(const char* path)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+std::string
+receiveAll(int fd, size_t len)
+{
+    std::string result;
+    char buf[64];
+    while (result.size() < len) {
+        ssize_t received = recv(fd, buf, sizeof(buf), 0);
+        if (received <= 0) {
+            break;
+        }
+        result.append(buf, size_t(received));
+    }
+    return result;
+}
+} // end anonymous namespace
+
+SCENARIO("Connections can be made over a Unix domain socket")
+{
+    const char* path = "unix_socket_test.sock";
+    UnixSocketConnectionSource source(path);
+
+    WHEN("The source is not started")
+    {
+        THEN("It does not accept connections")
+        {
+            CHECK_FALSE(source.listening());
+            CHECK(connectClient(path) < 0);
+            CHECK_FALSE(source.newConnection());
+        }
+
+        THEN("It reports the capacity and the counters of the output queues")
+        {
+            CHECK(source.queueCapacity() == 8192);
+            REQUIRE(source.queueStats());
+            CHECK(source.queueStats()->overflows == 0);
+        }
+    }
+
+    WHEN("The source is started")
+    {
+        source.start();
+        REQUIRE(source.listening());
+
+        THEN("No connection is returned while no client has connected")
+        {
+            CHECK_FALSE(source.newConnection());
+        }
+
+        AND_WHEN("A client connects")
+        {
+            int client = connectClient(path);
+            REQUIRE(client >= 0);
+            auto conn = source.newConnection();
+            REQUIRE(conn);
+            CHECK(conn->isConnected());
+            CHECK(conn->getDataIn().streamType() == StreamType::Unix);
+
+            THEN("Data sent by the client can be read from the connection")
+            {
+                const char request[] = "0100";
+                CHECK(send(client, request, 4, 0) == 4);
+
+                DataIn& in = conn->getDataIn();
+                std::string received;
+                while (in.hasNext()) {
+                    received.push_back(char(in.next()));
+                }
+                CHECK(received == "0100");
+            }
+
+            THEN("Data written to the connection is received by the client after a flush")
+            {
+                DataOut& out = conn->getDataOut();
+                out.writeBuffer("reply\n", 6);
+                CHECK(conn->queuedOutput() == 6);
+                conn->flush();
+                CHECK(conn->queuedOutput() == 0);
+                CHECK(receiveAll(client, 6) == "reply\n");
+            }
+
+            THEN("The connection is closed when the client disconnects")
+            {
+                close(client);
+                client = -1;
+                CHECK_FALSE(conn->getDataIn().hasNext());
+                CHECK_FALSE(conn->isConnected());
+            }
+
+            THEN("The client sees the connection close when it is stopped")
+            {
+                conn->stop();
+                CHECK_FALSE(conn->isConnected());
+                CHECK(receiveAll(client, 1) == "");
+            }
+
+            if (client >= 0) {
+                close(client);
+            }
+        }
+
+        AND_WHEN("The source is stopped")
+        {
+            source.stop();
+
+            THEN("The socket file is removed")
+            {
+                struct stat fileStat;
+                CHECK_FALSE(source.listening());
+                CHECK(stat(path, &fileStat) != 0);
+            }
+        }
+    }
+}
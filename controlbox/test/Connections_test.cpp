@@ -114,6 +114,26 @@ SCENARIO("Connections are generated by connection sources and managed by a conne
                         CHECK(out2->str() == "conn 2 test");
                     }
 
+                    AND_WHEN("A command handler disconnects all connections while they are processed")
+                    {
+                        *in << "a";
+                        *in2 << "b";
+                        uint8_t handled = 0;
+                        pool.process([&pool, &handled](DataIn& in, DataOut& out) {
+                            in.push(out);
+                            ++handled;
+                            pool.disconnect();
+                        });
+
+                        THEN("All connections are processed before they are removed")
+                        {
+                            CHECK(handled == 2);
+                            CHECK(out->str() == "a");
+                            CHECK(out2->str() == "b");
+                            CHECK(pool.size() == 0);
+                        }
+                    }
+
                     AND_WHEN("Both connections disconnect, the pool is empty again")
                     {
                         pool.updateConnections();
@@ -141,8 +161,7 @@ SCENARIO("Connections are generated by connection sources and managed by a conne
 
             auto echoAndLogFunction = [&pool](DataIn& in, DataOut& out) {
                 if (in.available()) {
-                    const char log[] = "<log>";
-                    pool.logDataOut().writeBuffer(log, 5);
+                    pool.log("", "log", 3);
                     in.push(out);
                 }
             };
@@ -155,28 +174,64 @@ SCENARIO("Connections are generated by connection sources and managed by a conne
             {
                 *in1 << "test1";
                 pool.process(echoAndLogFunction);
-                THEN("It is only sent over the connection sending the message")
+                THEN("It is only sent over the connection sending the message, after the reply")
                 {
-                    CHECK(out1->str() == "<log>test1");
+                    CHECK(out1->str() == "test1<log>");
                     CHECK(out2->str() == "");
                 }
             }
 
             WHEN("A log occurs outside of processing a message")
             {
-                const char log[] = "<log2>";
-                pool.logDataOut().writeBuffer(log, 5);
-                pool.logDataOut().write('>'); // ensure write funciton is also covered by test
+                pool.log("", "log2", 4);
+
+                THEN("It is not written to the connections immediately")
+                {
+                    CHECK(out1->str() == "");
+                    CHECK(out2->str() == "");
+                }
 
                 *in1 << "test1";
                 pool.process(echoFunction);
-                THEN("It is sent over all connections")
+                THEN("It is sent over all connections before processing")
                 {
                     CHECK(out1->str() == "<log2>test1");
                     CHECK(out2->str() == "<log2>");
                 }
             }
 
+            WHEN("The same message is logged repeatedly")
+            {
+                for (uint8_t i = 0; i < 5; i++) {
+                    pool.log("WARNING:", "oops", 4);
+                }
+                pool.log("!", "event", 5);
+                pool.process(echoFunction);
+
+                THEN("It is sent once, with the number of repeats")
+                {
+                    CHECK(out1->str() == "<WARNING:oops (repeated 5 times)><!event>");
+                }
+            }
+
+            WHEN("More messages are logged than fit in the log queue")
+            {
+                std::string message(100, 'x');
+                for (uint8_t i = 0; i < 10; i++) {
+                    message[0] = 'a' + i; // prevent coalescing
+                    pool.log("", message.data(), message.size());
+                }
+                pool.process(echoFunction);
+
+                THEN("The messages that didn't fit are dropped and the number of dropped messages is sent")
+                {
+                    CHECK(pool.droppedLogMessages() == 6);
+                    CHECK(out1->str().find("<!Log messages dropped: 6>") != std::string::npos);
+                    CHECK(out1->str().find("<dxxxx") != std::string::npos);
+                    CHECK(out1->str().find("<exxxx") == std::string::npos);
+                }
+            }
+
             WHEN("The connection pool is stopped")
             {
                 pool.stopAll();
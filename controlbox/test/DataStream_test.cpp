@@ -0,0 +1,53 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DataStream.h"
+#include "DataStreamIo.h"
+
+#include <catch.hpp>
+#include <sstream>
+
+using namespace cbox;
+
+SCENARIO("An EncodedDataOut writes a buffer as hex in chunks")
+{
+    uint8_t data[100];
+    for (uint8_t i = 0; i < sizeof(data); i++) {
+        data[i] = i * 7;
+    }
+
+    std::stringstream bytewise;
+    OStreamDataOut bytewiseOut(bytewise);
+    EncodedDataOut bytewiseEncoded(bytewiseOut);
+    for (auto d : data) {
+        bytewiseEncoded.write(d);
+    }
+
+    std::stringstream buffered;
+    OStreamDataOut bufferedOut(buffered);
+    EncodedDataOut bufferedEncoded(bufferedOut);
+    CHECK(bufferedEncoded.writeBuffer(data, sizeof(data)));
+
+    THEN("The output and the CRC are the same as when the bytes are written one by one")
+    {
+        CHECK(buffered.str().size() == 200);
+        CHECK(buffered.str() == bytewise.str());
+        CHECK(bufferedEncoded.crc() == bytewiseEncoded.crc());
+    }
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2020 BrewPi
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Storage churn benchmark. It is hidden from the normal test run, run it with:
+ * make benchmark
+ * or
+ * ./build/cbox_test_runner "[benchmark]"
+ */
+
+#include "ArrayEepromAccess.h"
+#include "EepromObjectStorage.h"
+#include <algorithm>
+#include <catch.hpp>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace cbox;
+
+/**
+ * Wraps an EepromAccess and counts all accesses to it
+ */
+class InstrumentedEepromAccess : public EepromAccess {
+public:
+    struct Counters {
+        uint32_t byteReads = 0;
+        uint32_t byteWrites = 0;
+        uint32_t blockReads = 0;
+        uint32_t blockWrites = 0;
+        uint32_t blockBytesRead = 0;
+        uint32_t blockBytesWritten = 0;
+    };
+
+    InstrumentedEepromAccess(EepromAccess& _eeprom)
+        : eeprom(_eeprom)
+    {
+    }
+    virtual ~InstrumentedEepromAccess() = default;
+
+    virtual uint8_t readByte(eeprom_offset_t offset) const override final
+    {
+        ++counters.byteReads;
+        return eeprom.readByte(offset);
+    }
+
+    virtual void writeByte(eeprom_offset_t offset, uint8_t value) override final
+    {
+        ++counters.byteWrites;
+        eeprom.writeByte(offset, value);
+    }
+
+    virtual void readBlock(uint8_t* target, eeprom_offset_t offset, eeprom_offset_t size) const override final
+    {
+        ++counters.blockReads;
+        counters.blockBytesRead += size;
+        eeprom.readBlock(target, offset, size);
+    }
+
+    virtual void writeBlock(eeprom_offset_t offset, const uint8_t* source, eeprom_offset_t size) override final
+    {
+        ++counters.blockWrites;
+        counters.blockBytesWritten += size;
+        eeprom.writeBlock(offset, source, size);
+    }
+
+    virtual eeprom_offset_t length() const override final
+    {
+        return eeprom.length();
+    }
+
+    virtual void clear() override final
+    {
+        eeprom.clear();
+    }
+
+    virtual void flush() override final
+    {
+        eeprom.flush();
+    }
+
+    mutable Counters counters;
+
+private:
+    EepromAccess& eeprom;
+};
+
+namespace {
+
+// Approximate persisted sizes (groups, type and encoded protobuf data) of the BrewBlox block types.
+// Blocks with variable length data have a minimum and maximum size.
+struct BlockSize {
+    const char* name;
+    uint16_t min;
+    uint16_t max;
+    uint8_t weight; // relative frequency in a typical installation
+};
+
+const std::vector<BlockSize> blockSizes = {
+    {"TempSensorOneWire", 16, 18, 10},
+    {"TempSensorMock", 10, 30, 2},
+    {"SetpointSensorPair", 18, 30, 6},
+    {"Pid", 40, 60, 5},
+    {"ActuatorPwm", 20, 40, 4},
+    {"DigitalActuator", 14, 50, 8},
+    {"ActuatorOffset", 20, 30, 1},
+    {"Mutex", 6, 8, 1},
+    {"Balancer", 4, 4, 1},
+    {"DS2413", 14, 16, 3},
+    {"DS2408", 14, 16, 1},
+    {"MotorValve", 16, 40, 2},
+    {"ActuatorLogic", 30, 210, 3},
+    {"SetpointProfile", 12, 400, 2},
+    {"TempSensorCombi", 12, 30, 1},
+};
+
+// Average EEPROM space used per object: data, the byte added by the storage, the over provisioning and the object header
+double
+averageObjectFootprint()
+{
+    double total = 0;
+    uint32_t weights = 0;
+    for (auto& b : blockSizes) {
+        double size = (b.min + b.max) / 2.0 + 1;
+        total += b.weight * (size + std::max(size / 8, 4.0) + 7);
+        weights += b.weight;
+    }
+    return total / weights;
+}
+
+struct OperationStats {
+    uint32_t count = 0;
+    uint32_t failed = 0;
+    double totalUs = 0;
+    double worstUs = 0;
+    InstrumentedEepromAccess::Counters accesses;
+
+    void add(double us, const InstrumentedEepromAccess::Counters& before, const InstrumentedEepromAccess::Counters& after)
+    {
+        ++count;
+        totalUs += us;
+        worstUs = std::max(worstUs, us);
+        accesses.byteReads += after.byteReads - before.byteReads;
+        accesses.byteWrites += after.byteWrites - before.byteWrites;
+        accesses.blockReads += after.blockReads - before.blockReads;
+        accesses.blockWrites += after.blockWrites - before.blockWrites;
+        accesses.blockBytesRead += after.blockBytesRead - before.blockBytesRead;
+        accesses.blockBytesWritten += after.blockBytesWritten - before.blockBytesWritten;
+    }
+
+    void print(const char* name) const
+    {
+        auto perOp = [this](uint32_t v) { return count ? double(v) / count : 0.0; };
+        printf("%-9s %6u ops %5u failed | avg %8.2f us  worst %8.2f us | per op: byte reads %7.1f  byte writes %6.1f  block reads %5.1f (%7.1f bytes)  block writes %5.1f (%6.1f bytes)\n",
+               name, count, failed,
+               count ? totalUs / count : 0.0, worstUs,
+               perOp(accesses.byteReads), perOp(accesses.byteWrites),
+               perOp(accesses.blockReads), perOp(accesses.blockBytesRead),
+               perOp(accesses.blockWrites), perOp(accesses.blockBytesWritten));
+    }
+};
+
+// fillPercent is the part of the free space that the target number of objects uses on average
+template <size_t eepromSize>
+void
+runChurn(uint32_t operations, uint8_t fillPercent)
+{
+    ArrayEepromAccess<eepromSize> array;
+    InstrumentedEepromAccess eeprom(array);
+    EepromObjectStorage storage(eeprom);
+    auto targetObjects = uint16_t(storage.freeSpace() * fillPercent / 100 / averageObjectFootprint());
+
+    std::mt19937 rng(1234); // fixed seed, so results are comparable between runs
+    std::vector<uint32_t> weights;
+    for (auto& b : blockSizes) {
+        weights.push_back(b.weight);
+    }
+    std::discrete_distribution<size_t> typeDist(weights.begin(), weights.end());
+
+    struct StoredObject {
+        size_t type;
+        uint16_t size;
+    };
+    std::map<storage_id_t, StoredObject> stored;
+    storage_id_t nextId = 100;
+
+    OperationStats creates, writes, deletes, loads, bufferedLoads;
+    double worstFragmentation = 0;
+    double totalFragmentation = 0;
+    stream_size_t minFreeSpace = storage.freeSpace();
+
+    auto randomSize = [&rng](size_t type) {
+        std::uniform_int_distribution<uint16_t> dist(blockSizes[type].min, blockSizes[type].max);
+        return dist(rng);
+    };
+
+    auto store = [&storage](storage_id_t id, uint16_t size) {
+        return storage.storeObject(id, [size](DataOut& out) -> CboxError {
+            for (uint16_t i = 0; i < size; i++) {
+                if (!out.write(uint8_t(i))) {
+                    return CboxError::PERSISTED_STORAGE_WRITE_ERROR;
+                }
+            }
+            return CboxError::OK;
+        });
+    };
+
+    auto timed = [&eeprom](OperationStats& stats, const std::function<bool()>& op) {
+        auto before = eeprom.counters;
+        auto start = std::chrono::steady_clock::now();
+        bool success = op();
+        auto end = std::chrono::steady_clock::now();
+        stats.add(std::chrono::duration<double, std::micro>(end - start).count(), before, eeprom.counters);
+        if (!success) {
+            ++stats.failed;
+        }
+    };
+
+    std::uniform_int_distribution<uint32_t> opDist(0, 99);
+    for (uint32_t i = 0; i < operations; i++) {
+        uint32_t op = opDist(rng);
+        // keep the number of objects around the target: create more often when below, delete more often when above
+        uint32_t createChance = stored.size() < targetObjects ? 30 : 5;
+        uint32_t deleteChance = stored.size() > targetObjects ? 30 : 5;
+
+        if (op < createChance || stored.empty()) {
+            size_t type = typeDist(rng);
+            uint16_t size = randomSize(type);
+            storage_id_t id = nextId++;
+            timed(creates, [&]() {
+                if (store(id, size) == CboxError::OK) {
+                    stored[id] = StoredObject{type, size};
+                    return true;
+                }
+                return false;
+            });
+        } else if (op < createChance + deleteChance) {
+            auto it = stored.begin();
+            std::advance(it, std::uniform_int_distribution<size_t>(0, stored.size() - 1)(rng));
+            storage_id_t id = it->first;
+            timed(deletes, [&]() {
+                stored.erase(id);
+                return storage.disposeObject(id);
+            });
+        } else {
+            auto it = stored.begin();
+            std::advance(it, std::uniform_int_distribution<size_t>(0, stored.size() - 1)(rng));
+            storage_id_t id = it->first;
+            uint16_t size = randomSize(it->second.type);
+            timed(writes, [&]() {
+                if (store(id, size) == CboxError::OK) {
+                    stored[id].size = size;
+                    return true;
+                }
+                return false;
+            });
+        }
+
+        auto freeSpace = storage.freeSpace();
+        auto continuous = storage.continuousFreeSpace();
+        double fragmentation = freeSpace ? 1.0 - double(continuous) / freeSpace : 0.0;
+        worstFragmentation = std::max(worstFragmentation, fragmentation);
+        totalFragmentation += fragmentation;
+        minFreeSpace = std::min(minFreeSpace, freeSpace);
+    }
+
+    // load all objects like at boot, buffered and unbuffered
+    auto handler = [](const storage_id_t&, RegionDataIn& in) -> CboxError {
+        in.spool();
+        return CboxError::OK;
+    };
+    timed(loads, [&]() { return storage.retrieveObjects(handler) == CboxError::OK; });
+    timed(bufferedLoads, [&]() { return storage.retrieveObjectsBuffered(handler) == CboxError::OK; });
+
+    printf("\nEEPROM %zu bytes, %u operations, target %u objects (%u%% full), %zu objects at end\n",
+           eepromSize, operations, targetObjects, fillPercent, stored.size());
+    creates.print("create");
+    writes.print("write");
+    deletes.print("delete");
+    loads.print("load");
+    bufferedLoads.print("load buf");
+    printf("defrags: %u (1 per %.1f stores)\n", storage.defragCount(),
+           storage.defragCount() ? double(creates.count + writes.count) / storage.defragCount() : 0.0);
+    printf("free space: %u at end, %u minimum | fragmentation: %.1f%% average, %.1f%% worst\n",
+           storage.freeSpace(), minFreeSpace, 100.0 * totalFragmentation / operations, 100.0 * worstFragmentation);
+
+    // check that all objects are still intact
+    for (auto& kv : stored) {
+        CHECK(storage.retrieveObject(kv.first, [&kv](RegionDataIn& in) -> CboxError {
+            CHECK(in.available() == kv.second.size + 1);
+            return CboxError::OK;
+        }) == CboxError::OK);
+    }
+}
+
+} // end anonymous namespace
+
+TEST_CASE("Storage churn benchmark", "[.][benchmark]")
+{
+    runChurn<2048>(5000, 50);
+    runChurn<2048>(5000, 75);
+    runChurn<16384>(5000, 75);
+}
@@ -317,6 +317,33 @@ SCENARIO("Storing and retreiving blocks with EEPROM storage")
                     CHECK(storage.retrieveObjects(idCollector) == CboxError::OK);
                     CHECK(ids == std::vector<obj_id_t>({1, 3, 4}));
                 }
+
+                AND_THEN("A buffered handler handling all objects gives the same result as the unbuffered handler")
+                {
+                    std::vector<obj_id_t> ids;
+                    std::vector<uint8_t> data;
+                    auto dataCollector = [&ids, &data](const storage_id_t& id, DataIn& objInStorage) -> CboxError {
+                        ids.push_back(id);
+                        while (objInStorage.hasNext()) {
+                            data.push_back(objInStorage.next());
+                        }
+                        return CboxError::OK;
+                    };
+                    CHECK(storage.retrieveObjects(dataCollector) == CboxError::OK);
+                    auto unbufferedIds = ids;
+                    auto unbufferedData = data;
+                    ids.clear();
+                    data.clear();
+
+                    auto streamTypeChecker = [&dataCollector](const storage_id_t& id, RegionDataIn& objInStorage) -> CboxError {
+                        CHECK(objInStorage.streamType() == StreamType::Eeprom);
+                        return dataCollector(id, objInStorage);
+                    };
+                    CHECK(storage.retrieveObjectsBuffered(streamTypeChecker) == CboxError::OK);
+                    CHECK(ids == std::vector<obj_id_t>({1, 3, 4}));
+                    CHECK(ids == unbufferedIds);
+                    CHECK(data == unbufferedData);
+                }
             }
 
             AND_THEN("When a storage stream error occurs when handling a block, blocks processing is stopped")
@@ -549,6 +576,34 @@ SCENARIO("Storing and retreiving blocks with EEPROM storage")
                     }
                 }
             }
+
+            AND_WHEN("An existing object grows and can only be relocated after a defrag")
+            {
+                LongIntVectorObject bigger = big;
+                for (uint8_t i = 0; i < 8; i++) {
+                    bigger.values.push_back(LongIntObject(0x88888888));
+                }
+                auto defragsBefore = storage.defragCount();
+                auto res = saveObjectToStorage(obj_id_t(1), bigger);
+
+                THEN("It succeeds and the relocated object has the new value")
+                {
+                    CHECK(storage.defragCount() == defragsBefore + 1);
+                    CHECK(res == CboxError::OK);
+                    LongIntVectorObject received;
+                    CHECK(CboxError::OK == retreiveObjectFromStorage(1, received));
+                    CHECK(received == bigger);
+                }
+
+                THEN("The other big objects still have the right value")
+                {
+                    for (id = 3; id < 10; id = id + 2) {
+                        LongIntVectorObject received;
+                        CHECK(CboxError::OK == retreiveObjectFromStorage(id, received));
+                        CHECK(received == big);
+                    }
+                }
+            }
         }
     }
 
@@ -600,6 +655,52 @@ SCENARIO("Storing and retreiving blocks with EEPROM storage")
         }
     }
 
+    WHEN("An object is stored, it is serialized only once if it fits in the RAM buffer")
+    {
+        MockStreamObject obj;
+        uint16_t calls = 0;
+        uint16_t length = 100;
+        obj.streamPersistedToFunc = [&calls, &length](cbox::DataOut& out) {
+            ++calls;
+            for (uint16_t i = 0; i < length; i++) {
+                if (!out.write(uint8_t(i))) {
+                    return CboxError::OUTPUT_STREAM_WRITE_ERROR;
+                }
+            }
+            return CboxError::OK;
+        };
+
+        auto checkStored = [&storage, &length]() {
+            auto dataHandler = [&length](DataIn& in) -> CboxError {
+                CHECK(in.available() == length + 1); // data + crc
+                std::vector<uint8_t> expected;
+                std::vector<uint8_t> received;
+                for (uint16_t i = 0; i < length; i++) {
+                    expected.push_back(uint8_t(i));
+                    received.push_back(in.next());
+                }
+                CHECK(expected == received);
+                return CboxError::OK;
+            };
+            CHECK(storage.retrieveObject(obj_id_t(1), dataHandler) == CboxError::OK);
+        };
+
+        THEN("A small object is streamed once")
+        {
+            CHECK(saveObjectToStorage(obj_id_t(1), obj) == CboxError::OK);
+            CHECK(calls == 1);
+            checkStored();
+        }
+
+        THEN("An object too big for the buffer is streamed twice")
+        {
+            length = 600;
+            CHECK(saveObjectToStorage(obj_id_t(1), obj) == CboxError::OK);
+            CHECK(calls == 2);
+            checkStored();
+        }
+    }
+
     WHEN("An object indicates it does not need persistence")
     {
         MockStreamObject obj;
@@ -616,3 +717,190 @@ SCENARIO("Storing and retreiving blocks with EEPROM storage")
         }
     }
 }
+
+SCENARIO("The size of the objects region in EEPROM is determined at runtime")
+{
+    auto saveObjectToStorage = [](EepromObjectStorage& storage, const obj_id_t& id, const Object& source) -> CboxError {
+        auto dataHandler = [&source](DataOut& out) -> CboxError {
+            return source.streamPersistedTo(out);
+        };
+        return storage.storeObject(id, dataHandler);
+    };
+
+    auto retreiveObjectFromStorage = [](EepromObjectStorage& storage, const obj_id_t& id, Object& target) -> CboxError {
+        auto dataHandler = [&target](DataIn& in) -> CboxError {
+            return target.streamFrom(in);
+        };
+        return storage.retrieveObject(id, dataHandler);
+    };
+
+    WHEN("EEPROM is larger than 2kb")
+    {
+        ArrayEepromAccess<16384> eeprom;
+        EepromObjectStorage storage(eeprom);
+
+        THEN("The objects region extends to the end of EEPROM")
+        {
+            CHECK(storage.objectsRegionLength() == 16384 - 32);
+            CHECK(storage.freeSpace() == 16384 - 32 - 3);
+        }
+
+        THEN("More objects can be stored than in 2kb")
+        {
+            LongIntVectorObject obj = {0x11111111, 0x22222222, 0x33333333, 0x44444444, 0x55555555, 0x66666666};
+            obj_id_t id = 1;
+            while (saveObjectToStorage(storage, id, obj) == CboxError::OK) {
+                ++id;
+            }
+            CHECK(id > 400);
+
+            LongIntVectorObject received;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(id - 1), received) == CboxError::OK);
+            CHECK(obj == received);
+        }
+    }
+
+    WHEN("An image of storage version 1 is loaded on a larger EEPROM")
+    {
+        // create a version 1 image by storing objects in 2kb and patching the header
+        ArrayEepromAccess<2048> oldEeprom;
+        {
+            EepromObjectStorage oldStorage(oldEeprom);
+            saveObjectToStorage(oldStorage, obj_id_t(1), LongIntObject(0x11111111));
+            saveObjectToStorage(oldStorage, obj_id_t(2), LongIntVectorObject{0x11111111, 0x22222222});
+            saveObjectToStorage(oldStorage, obj_id_t(3), LongIntObject(0x33333333));
+            oldStorage.disposeObject(obj_id_t(3));
+        }
+        uint16_t versionOneHeader = 0x69 << 8 | 0x01;
+        oldEeprom.put(EepromLocation(header), versionOneHeader);
+        oldEeprom.put(EepromLocation(objectsLength), uint16_t(0));
+
+        ArrayEepromAccess<4096> eeprom;
+        eeprom.writeBlock(0, oldEeprom.eepromData(), 2048);
+        EepromObjectStorage storage(eeprom);
+
+        THEN("The header is migrated to the current version")
+        {
+            uint16_t header;
+            eeprom.get(EepromLocation(header), header);
+            CHECK(header == (0x69 << 8 | EepromObjectStorage::storageVersion()));
+            CHECK(storage.objectsRegionLength() == 4096 - 32);
+        }
+
+        THEN("The existing objects are preserved")
+        {
+            LongIntObject received1;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(1), received1) == CboxError::OK);
+            CHECK(uint32_t(received1) == 0x11111111);
+
+            LongIntVectorObject received2;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(2), received2) == CboxError::OK);
+            CHECK(received2 == LongIntVectorObject{0x11111111, 0x22222222});
+
+            LongIntObject received3;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(3), received3) == CboxError::PERSISTED_OBJECT_NOT_FOUND);
+        }
+
+        THEN("The added space is free and merged with the free space at the end")
+        {
+            EepromObjectStorage sameSizeStorage(oldEeprom); // migrates without extending
+            CHECK(sameSizeStorage.objectsRegionLength() == 2048 - 32);
+            CHECK(storage.freeSpace() == sameSizeStorage.freeSpace() + 2048);
+            CHECK(storage.continuousFreeSpace() == sameSizeStorage.continuousFreeSpace() + 2048);
+        }
+
+        THEN("A storage object created later on the same EEPROM keeps the migrated objects")
+        {
+            EepromObjectStorage storage2(eeprom);
+            LongIntObject received1;
+            CHECK(retreiveObjectFromStorage(storage2, obj_id_t(1), received1) == CboxError::OK);
+            CHECK(uint32_t(received1) == 0x11111111);
+            CHECK(storage2.freeSpace() == storage.freeSpace());
+        }
+    }
+
+    WHEN("The header has an objects region that is larger than the EEPROM")
+    {
+        ArrayEepromAccess<4096> eeprom;
+        stream_size_t freeSpaceBefore = 0;
+        {
+            EepromObjectStorage oldStorage(eeprom);
+            saveObjectToStorage(oldStorage, obj_id_t(1), LongIntObject(0x11111111));
+            freeSpaceBefore = oldStorage.freeSpace();
+        }
+        eeprom.put(EepromLocation(objectsLength), uint16_t(8192));
+        EepromObjectStorage storage(eeprom);
+
+        THEN("The region is limited to the EEPROM and the objects are kept")
+        {
+            CHECK(storage.objectsRegionLength() == 4096 - 32);
+            CHECK(storage.freeSpace() == freeSpaceBefore);
+            LongIntObject received;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(1), received) == CboxError::OK);
+            CHECK(uint32_t(received) == 0x11111111);
+        }
+    }
+
+    WHEN("An image of storage version 1 is loaded on an EEPROM that is 1 byte short of 2kb, like on the Photon")
+    {
+        ArrayEepromAccess<2048> oldEeprom;
+        {
+            EepromObjectStorage oldStorage(oldEeprom);
+            saveObjectToStorage(oldStorage, obj_id_t(1), LongIntObject(0x11111111));
+            saveObjectToStorage(oldStorage, obj_id_t(2), LongIntVectorObject{0x11111111, 0x22222222});
+        }
+        uint16_t versionOneHeader = 0x69 << 8 | 0x01;
+        oldEeprom.put(EepromLocation(header), versionOneHeader);
+        oldEeprom.put(EepromLocation(objectsLength), uint16_t(0));
+
+        ArrayEepromAccess<2047> eeprom;
+        eeprom.writeBlock(0, oldEeprom.eepromData(), 2047);
+        EepromObjectStorage sameSizeStorage(oldEeprom);
+        EepromObjectStorage storage(eeprom);
+
+        THEN("The blocks are kept and the free space at the end is 1 byte shorter")
+        {
+            CHECK(storage.objectsRegionLength() == 2047 - 32);
+            CHECK(storage.freeSpace() == sameSizeStorage.freeSpace() - 1);
+
+            LongIntObject received1;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(1), received1) == CboxError::OK);
+            CHECK(uint32_t(received1) == 0x11111111);
+
+            LongIntVectorObject received2;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(2), received2) == CboxError::OK);
+            CHECK(received2 == LongIntVectorObject{0x11111111, 0x22222222});
+        }
+
+        THEN("New objects can be stored until the end of EEPROM")
+        {
+            LongIntObject obj(0x12345678);
+            obj_id_t id = 3;
+            while (saveObjectToStorage(storage, id, obj) == CboxError::OK) {
+                ++id;
+            }
+            CHECK(id > 100);
+            LongIntObject received;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(id - 1), received) == CboxError::OK);
+            CHECK(uint32_t(received) == 0x12345678);
+
+            EepromObjectStorage storage2(eeprom);
+            CHECK(retreiveObjectFromStorage(storage2, obj_id_t(1), received) == CboxError::OK);
+            CHECK(uint32_t(received) == 0x11111111);
+        }
+    }
+
+    WHEN("EEPROM does not contain a valid header")
+    {
+        ArrayEepromAccess<4096> eeprom;
+        eeprom.put(EepromLocation(header), uint16_t(0x1234));
+        EepromObjectStorage storage(eeprom);
+
+        THEN("It is formatted as one big disposed block")
+        {
+            CHECK(storage.objectsRegionLength() == 4096 - 32);
+            CHECK(storage.freeSpace() == 4096 - 32 - 3);
+            CHECK(storage.continuousFreeSpace() == storage.freeSpace());
+        }
+    }
+}
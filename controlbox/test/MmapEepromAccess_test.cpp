@@ -0,0 +1,133 @@
+/*
+ * Copyright 2020 BrewPi
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "posix/MmapEepromAccess.h"
+
+#include "EepromObjectStorage.h"
+#include "TestObjects.h"
+#include <catch.hpp>
+#include <cstdio>
+#include <fstream>
+
+using namespace cbox;
+
+SCENARIO("A memory mapped file can be used as EEPROM")
+{
+    const char* path = "mmap_eeprom_test.bin";
+    std::remove(path);
+
+    auto saveObjectToStorage = [](EepromObjectStorage& storage, const obj_id_t& id, const Object& source) -> CboxError {
+        auto dataHandler = [&source](DataOut& out) -> CboxError {
+            return source.streamPersistedTo(out);
+        };
+        return storage.storeObject(id, dataHandler);
+    };
+
+    auto retreiveObjectFromStorage = [](EepromObjectStorage& storage, const obj_id_t& id, Object& target) -> CboxError {
+        auto dataHandler = [&target](DataIn& in) -> CboxError {
+            return target.streamFrom(in);
+        };
+        return storage.retrieveObject(id, dataHandler);
+    };
+
+    WHEN("The file does not exist")
+    {
+        MmapEepromAccess eeprom(path, 4096);
+
+        THEN("It is created with the requested size and reads as zeros")
+        {
+            CHECK(eeprom.isMapped());
+            CHECK(eeprom.isNew());
+            CHECK(eeprom.length() == 4096);
+            CHECK(eeprom.readByte(0) == 0);
+            CHECK(eeprom.readByte(4095) == 0);
+        }
+
+        THEN("Data can be written and read back")
+        {
+            eeprom.writeByte(10, 0x12);
+            uint32_t value = 0x11223344;
+            eeprom.put(100, value);
+
+            CHECK(eeprom.readByte(10) == 0x12);
+            uint32_t received = 0;
+            CHECK(eeprom.get(100, received) == 0x11223344);
+        }
+
+        THEN("Accesses outside of the file are ignored")
+        {
+            eeprom.writeByte(4096, 0x12);
+            CHECK(eeprom.readByte(4096) == 0);
+            uint8_t data[4] = {1, 2, 3, 4};
+            eeprom.writeBlock(4094, data, 4);
+            CHECK(eeprom.readByte(4094) == 0);
+        }
+    }
+
+    WHEN("Objects are stored in the file")
+    {
+        {
+            MmapEepromAccess eeprom(path, 4096);
+            EepromObjectStorage storage(eeprom);
+            CHECK(saveObjectToStorage(storage, obj_id_t(1), LongIntObject(0x11111111)) == CboxError::OK);
+            CHECK(saveObjectToStorage(storage, obj_id_t(2), LongIntVectorObject{0x11111111, 0x22222222}) == CboxError::OK);
+        }
+
+        THEN("The file has been written")
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            CHECK(file.tellg() == 4096);
+        }
+
+        THEN("They can be loaded again after the file is reopened")
+        {
+            MmapEepromAccess eeprom(path, 4096);
+            CHECK(!eeprom.isNew());
+            EepromObjectStorage storage(eeprom);
+
+            LongIntObject received1;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(1), received1) == CboxError::OK);
+            CHECK(uint32_t(received1) == 0x11111111);
+
+            LongIntVectorObject received2;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(2), received2) == CboxError::OK);
+            CHECK(received2 == LongIntVectorObject{0x11111111, 0x22222222});
+        }
+
+        THEN("The file can be grown, which extends the storage region")
+        {
+            MmapEepromAccess eeprom(path, 8192);
+            CHECK(eeprom.length() == 8192);
+            EepromObjectStorage storage(eeprom);
+            CHECK(storage.objectsRegionLength() == 8192 - 32);
+
+            LongIntObject received1;
+            CHECK(retreiveObjectFromStorage(storage, obj_id_t(1), received1) == CboxError::OK);
+            CHECK(uint32_t(received1) == 0x11111111);
+        }
+
+        THEN("The file is not shrunk when a smaller size is requested")
+        {
+            MmapEepromAccess eeprom(path, 1024);
+            CHECK(eeprom.length() == 4096);
+        }
+    }
+
+    std::remove(path);
+}
@@ -159,6 +159,7 @@ SCENARIO("A container to hold objects")
 
         THEN("The object is skipped in an update")
         {
+            cbox::tracing::setCategories(cbox::tracing::ALL_CATEGORIES);
             for (update_t now = 0; now < 5500; now += 100) {
                 container.update(now);
             }
@@ -169,6 +170,7 @@ SCENARIO("A container to hold objects")
                 }
             }
             CHECK(updates == 0);
+            cbox::tracing::setCategories(cbox::tracing::defaultCategories());
         }
     }
 }
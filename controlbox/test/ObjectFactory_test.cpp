@@ -22,18 +22,63 @@
 #include "ObjectFactory.h"
 #include "TestObjects.h"
 #include <catch.hpp>
+#include <stdexcept>
 #include <tuple>
 
+namespace {
+struct ClashingInterface {
+};
+
+// a system object with the same ID as an interface, it is not in an object registry
+class ClashingObject : public cbox::ObjectBase<1500> {
+public:
+    virtual cbox::CboxError streamTo(cbox::DataOut&) const override final
+    {
+        return cbox::CboxError::OK;
+    }
+    virtual cbox::CboxError streamFrom(cbox::DataIn&) override final
+    {
+        return cbox::CboxError::OK;
+    }
+    virtual cbox::CboxError streamPersistedTo(cbox::DataOut&) const override final
+    {
+        return cbox::CboxError::OK;
+    }
+    virtual cbox::update_t update(const cbox::update_t&) override final
+    {
+        return cbox::Object::update_never(0);
+    }
+};
+}
+
+namespace cbox {
+template <>
+const obj_type_t
+interfaceIdImpl<ClashingInterface>()
+{
+    return 1500;
+}
+} // end namespace cbox
+
 using namespace cbox;
 
+namespace {
+std::shared_ptr<Object>
+failToCreate(ObjectContainer&)
+{
+    return std::shared_ptr<LongIntVectorObject>(); // to test running out of memory
+}
+}
+
 SCENARIO("An object can be created by an ObjectFactory by resolving the type id")
 {
-    ObjectFactory factory = {
-        {LongIntObject::staticTypeId(), std::make_shared<LongIntObject>},
-        {LongIntVectorObject::staticTypeId(), std::make_shared<LongIntVectorObject>},
-        {
-            1234, []() { return std::shared_ptr<LongIntVectorObject>(); } // to test running out of memory
-        }};
+    static const ObjectFactoryEntry entries[] = {
+        {LongIntObject::staticTypeId(), &detail::makeObject<LongIntObject>},
+        {LongIntVectorObject::staticTypeId(), &detail::makeObject<LongIntVectorObject>},
+        {1234, &failToCreate},
+    };
+    ObjectFactory factory(entries);
+    ObjectContainer objects;
 
     const obj_type_t longIntType = LongIntObject::staticTypeId();
     const obj_type_t longIntVectorType = LongIntVectorObject::staticTypeId();
@@ -42,13 +87,13 @@ SCENARIO("An object can be created by an ObjectFactory by resolving the type id"
     {
         std::shared_ptr<Object> obj1;
         CboxError status1;
-        std::tie(status1, obj1) = factory.make(longIntType);
+        std::tie(status1, obj1) = factory.make(longIntType, objects);
         CHECK(status1 == CboxError::OK);
         CHECK(obj1->typeId() == longIntType);
 
         CboxError status2;
         std::shared_ptr<Object> obj2;
-        std::tie(status2, obj2) = factory.make(longIntVectorType);
+        std::tie(status2, obj2) = factory.make(longIntVectorType, objects);
 
         CHECK(status2 == CboxError::OK);
         CHECK(obj2->typeId() == longIntVectorType);
@@ -58,7 +103,11 @@ SCENARIO("An object can be created by an ObjectFactory by resolving the type id"
     {
         std::shared_ptr<Object> obj;
         CboxError status;
-        std::tie(status, obj) = factory.make(9999);
+        std::tie(status, obj) = factory.make(9999, objects);
+        CHECK(status == CboxError::OBJECT_NOT_CREATABLE);
+        CHECK(obj == nullptr);
+
+        std::tie(status, obj) = factory.make(1002, objects);
         CHECK(status == CboxError::OBJECT_NOT_CREATABLE);
         CHECK(obj == nullptr);
     }
@@ -67,8 +116,73 @@ SCENARIO("An object can be created by an ObjectFactory by resolving the type id"
     {
         std::shared_ptr<Object> obj;
         CboxError status;
-        std::tie(status, obj) = factory.make(1234);
+        std::tie(status, obj) = factory.make(1234, objects);
         CHECK(status == CboxError::INSUFFICIENT_HEAP);
         CHECK(obj == nullptr);
     }
 }
+
+SCENARIO("An object registry generates a factory table sorted by type id at compile time")
+{
+    using Registry = ObjectRegistry<PtrLongIntObject, LongIntVectorObject, UpdateCounter, LongIntObject>;
+    static_assert(Registry::size() == 4, "all types are in the table");
+    static_assert(Registry::table.entries[0].typeId == LongIntObject::staticTypeId(), "table is sorted");
+    static_assert(Registry::table.entries[3].typeId == PtrLongIntObject::staticTypeId(), "table is sorted");
+
+    ObjectContainer objects;
+    auto factory = Registry::factory();
+
+    WHEN("An object is created that takes the container as constructor argument")
+    {
+        auto obj = std::get<1>(factory.make(PtrLongIntObject::staticTypeId(), objects));
+
+        THEN("It is constructed with the container that is passed to the factory")
+        {
+            REQUIRE(obj);
+            CHECK(obj->typeId() == PtrLongIntObject::staticTypeId());
+        }
+    }
+
+    WHEN("Each type in the registry is created")
+    {
+        THEN("The object has the requested type")
+        {
+            for (auto id : {LongIntObject::staticTypeId(), LongIntVectorObject::staticTypeId(), UpdateCounter::staticTypeId(), PtrLongIntObject::staticTypeId()}) {
+                auto obj = std::get<1>(factory.make(id, objects));
+                REQUIRE(obj);
+                CHECK(obj->typeId() == id);
+            }
+        }
+    }
+}
+
+SCENARIO("An object can return a pointer to the member that implements an interface")
+{
+    NameableLongIntObject nameable;
+    LongIntVectorObject vec;
+
+    WHEN("The member implements the requested interface")
+    {
+        void* ptr = findInterface<LongIntObject, Nameable>(interfaceId<Nameable>(), nameable);
+
+        THEN("The pointer is cast to the interface")
+        {
+            Nameable* expected = &nameable;
+            CHECK(ptr == expected);
+        }
+    }
+
+    WHEN("The member does not implement the requested interface")
+    {
+        THEN("nullptr is returned")
+        {
+            CHECK(findInterface<LongIntVectorObject>(interfaceId<Nameable>(), vec) == nullptr);
+        }
+    }
+}
+
+SCENARIO("An object type ID that is also used as interface ID is detected in test builds")
+{
+    CHECK(interfaceId<ClashingInterface>() == 1500);
+    CHECK_THROWS_AS(ClashingObject(), std::logic_error);
+}
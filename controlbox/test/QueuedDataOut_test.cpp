@@ -0,0 +1,139 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "QueuedDataOut.h"
+#include <catch.hpp>
+#include <cstring>
+#include <string>
+
+using namespace cbox;
+
+namespace {
+// accepts a limited number of bytes, like a socket with a full send buffer
+class MockSocket {
+public:
+    size_t write(const uint8_t* data, size_t len, uint32_t /*timeout*/)
+    {
+        size_t toSend = std::min(len, budget);
+        sent.append(reinterpret_cast<const char*>(data), toSend);
+        budget -= toSend;
+        return toSend;
+    }
+
+    std::string sent;
+    size_t budget = 0;
+};
+
+void
+writeString(DataOut& out, const char* str)
+{
+    out.writeBuffer(str, strlen(str));
+}
+}
+
+SCENARIO("A QueuedDataOut sends data without blocking")
+{
+    MockSocket socket;
+    QueuedDataOutStats stats;
+    QueuedDataOut<MockSocket, 16> out(socket, stats);
+
+    WHEN("The socket accepts all data")
+    {
+        socket.budget = 1000;
+        writeString(out, "hello");
+        out.flush();
+
+        THEN("It is sent on flush")
+        {
+            CHECK(socket.sent == "hello");
+            CHECK(out.queued() == 0);
+        }
+    }
+
+    WHEN("The socket accepts part of the data")
+    {
+        socket.budget = 3;
+        writeString(out, "hello");
+        out.flush();
+
+        THEN("The rest stays queued and is sent when the socket accepts it")
+        {
+            CHECK(socket.sent == "hel");
+            CHECK(out.queued() == 2);
+
+            socket.budget = 10;
+            out.flush();
+            CHECK(socket.sent == "hello");
+            CHECK(out.queued() == 0);
+        }
+    }
+
+    WHEN("The queue is more than half full with a reply")
+    {
+        writeString(out, "0123456789");
+
+        THEN("Annotations are dropped as a whole and counted")
+        {
+            CHECK(out.writeBuffer("<log>", 5));
+            writeString(out, "ab");
+            CHECK(stats.droppedAnnotations == 1);
+
+            socket.budget = 100;
+            out.flush();
+            CHECK(socket.sent == "0123456789ab");
+        }
+
+        THEN("Annotations are sent again when the queue has drained")
+        {
+            socket.budget = 100;
+            writeString(out, "<log>");
+            out.flush();
+            CHECK(socket.sent == "0123456789<log>");
+            CHECK(stats.droppedAnnotations == 0);
+        }
+    }
+
+    WHEN("A reply doesn't fit in the queue")
+    {
+        bool success = out.writeBuffer("0123456789abcdefXYZ", 19);
+
+        THEN("The queue has overflowed and the connection should be closed")
+        {
+            CHECK_FALSE(success);
+            CHECK(out.hasOverflowed());
+            CHECK(stats.overflows == 1);
+            CHECK(stats.maxQueued == 16);
+            CHECK_FALSE(out.write('a'));
+        }
+    }
+
+    WHEN("A reply is bigger than the queue, but the socket accepts data while writing")
+    {
+        socket.budget = 100;
+        bool success = out.writeBuffer("0123456789abcdefXYZ", 19);
+        out.flush();
+
+        THEN("The full queue is sent to make space")
+        {
+            CHECK(success);
+            CHECK_FALSE(out.hasOverflowed());
+            CHECK(socket.sent == "0123456789abcdefXYZ");
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RingBuffer.h"
+#include <catch.hpp>
+#include <string>
+
+using namespace cbox;
+
+namespace {
+template <size_t N>
+std::string
+popAll(RingBuffer<N>& ring)
+{
+    std::string result;
+    while (!ring.empty()) {
+        const uint8_t* chunk;
+        size_t len = ring.peek(chunk);
+        result.append(reinterpret_cast<const char*>(chunk), len);
+        ring.consume(len);
+    }
+    return result;
+}
+}
+
+SCENARIO("A ring buffer is a fixed size byte queue")
+{
+    RingBuffer<8> ring;
+    CHECK(ring.empty());
+    CHECK(ring.space() == 8);
+
+    WHEN("Single bytes are pushed")
+    {
+        CHECK(ring.push('a'));
+        CHECK(ring.push('b'));
+
+        THEN("They can be read back in order")
+        {
+            CHECK(ring.size() == 2);
+            CHECK(popAll(ring) == "ab");
+        }
+    }
+
+    WHEN("More data is pushed than fits")
+    {
+        const uint8_t data[] = "0123456789";
+        CHECK(ring.push(data, 10) == 8);
+
+        THEN("The ring is full and pushing fails")
+        {
+            CHECK(ring.full());
+            CHECK_FALSE(ring.push('x'));
+            CHECK(popAll(ring) == "01234567");
+        }
+    }
+
+    WHEN("Data wraps around the end of the ring")
+    {
+        const uint8_t data[] = "0123456789";
+        ring.push(data, 6);
+        ring.consume(5);
+        CHECK(ring.push(data, 6) == 6);
+
+        THEN("peek returns the data in 2 contiguous chunks")
+        {
+            const uint8_t* chunk;
+            CHECK(ring.peek(chunk) == 3);
+            CHECK(popAll(ring) == "5012345");
+        }
+    }
+
+    WHEN("The ring is cleared")
+    {
+        ring.push('a');
+        ring.clear();
+        THEN("It is empty")
+        {
+            CHECK(ring.empty());
+            CHECK(ring.space() == 8);
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpscRingBuffer.h"
+#include "stdio/CommsStdIO.h"
+#include <catch.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace cbox;
+
+SCENARIO("A single producer, single consumer ring buffer")
+{
+    SpscRingBuffer<8> ring;
+
+    WHEN("Data is pushed")
+    {
+        const uint8_t data[] = "0123456789";
+        CHECK(ring.push(data, 6) == 6);
+        CHECK(ring.size() == 6);
+
+        THEN("It can be peeked and popped in bulk")
+        {
+            uint8_t first = 0;
+            CHECK(ring.peek(first));
+            CHECK(first == '0');
+
+            uint8_t target[10] = {0};
+            CHECK(ring.pop(target, 4) == 4);
+            CHECK(std::string(reinterpret_cast<char*>(target), 4) == "0123");
+        }
+
+        THEN("Pushing more than fits only pushes the free space, also when wrapping around")
+        {
+            uint8_t target[10] = {0};
+            ring.pop(target, 5);
+            CHECK(ring.push(data, 10) == 7);
+            CHECK_FALSE(ring.push('x'));
+            CHECK(ring.pop(target, 10) == 8);
+            CHECK(std::string(reinterpret_cast<char*>(target), 8) == "50123456");
+            CHECK(ring.empty());
+            CHECK_FALSE(ring.peek(target[0]));
+        }
+    }
+
+    WHEN("A producer thread and a consumer thread transfer a lot of data")
+    {
+        SpscRingBuffer<64> shared;
+        const size_t total = 100000;
+
+        std::thread producer([&shared]() {
+            uint8_t chunk[13];
+            size_t sent = 0;
+            while (sent < total) {
+                size_t len = std::min(sizeof(chunk), total - sent);
+                for (size_t i = 0; i < len; i++) {
+                    chunk[i] = uint8_t(sent + i);
+                }
+                size_t pushed = 0;
+                while (pushed < len) {
+                    pushed += shared.push(chunk + pushed, len - pushed);
+                }
+                sent += len;
+            }
+        });
+
+        size_t received = 0;
+        size_t errors = 0;
+        uint8_t chunk[17];
+        while (received < total) {
+            size_t len = shared.pop(chunk, sizeof(chunk));
+            for (size_t i = 0; i < len; i++) {
+                if (chunk[i] != uint8_t(received + i)) {
+                    ++errors;
+                }
+            }
+            received += len;
+        }
+        producer.join();
+
+        THEN("All data arrives in order")
+        {
+            CHECK(received == total);
+            CHECK(errors == 0);
+            CHECK(shared.empty());
+        }
+    }
+}
+
+SCENARIO("InputStreamPoll reads from an input stream in a separate thread")
+{
+    std::stringstream ss;
+    std::string input(10000, 'a');
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = char('a' + i % 26);
+    }
+    ss << input;
+
+    InputStreamPoll poll(ss);
+
+    std::string received;
+    while (poll.hasNext()) {
+        uint8_t buffer[100];
+        auto len = poll.readBuffer(buffer, sizeof(buffer));
+        received.append(reinterpret_cast<char*>(buffer), len);
+        if (len == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    CHECK(received == input);
+    CHECK(poll.available() == 0);
+}
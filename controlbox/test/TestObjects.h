@@ -244,7 +244,7 @@ public:
     }
     virtual ~NameableLongIntObject() = default;
 
-    static cbox::obj_type_t staticTypeId()
+    static constexpr cbox::obj_type_t staticTypeId()
     {
         return 1003;
     }
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the time to update all objects with different trace categories enabled.
+ * It is hidden from the normal test run, run it with:
+ * make benchmark
+ * or
+ * ./build/cbox_test_runner "[benchmark]"
+ */
+
+#include "ObjectContainer.h"
+#include "TestObjects.h"
+#include "Tracing.h"
+#include <catch.hpp>
+#include <chrono>
+#include <cstdio>
+
+using namespace cbox;
+
+namespace {
+
+void
+runUpdates(const char* name, uint8_t categories, uint16_t numObjects, uint32_t ticks)
+{
+    ObjectContainer container;
+    for (uint16_t i = 0; i < numObjects; i++) {
+        container.add(std::make_shared<UpdateCounter>(), 0xFF, 100 + i);
+    }
+
+    tracing::unpause();
+    tracing::setCategories(categories);
+
+    auto start = std::chrono::steady_clock::now();
+    for (update_t now = 0; now < ticks * 1000; now += 1000) {
+        container.update(now);
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    tracing::setCategories(tracing::defaultCategories());
+    tracing::pause();
+
+    printf("%-12s %3u objects: %8.3f us per update of all objects\n", name, numObjects, elapsed / ticks);
+}
+}
+
+TEST_CASE("Object update tracing benchmark", "[.][benchmark]")
+{
+    runUpdates("all traced", tracing::ALL_CATEGORIES, 40, 100000);
+    runUpdates("default", tracing::defaultCategories(), 40, 100000);
+    runUpdates("none traced", 0, 40, 100000);
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of Controlbox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TimelineExport.h"
+#include "DataStreamIo.h"
+#include "Tracing.h"
+
+#include <catch.hpp>
+#include <sstream>
+#include <thread>
+
+using namespace cbox;
+
+SCENARIO("Traced actions are recorded in a timeline with their duration")
+{
+    tracing::timeline::clear();
+
+    WHEN("Less events are recorded than fit in the timeline")
+    {
+        tracing::timeline::record(tracing::Action::UPDATE_OBJECT, 100, 1000, 50, 10);
+        tracing::timeline::record(tracing::Action::READ_OBJECT, 101, 1001, 70, 5);
+
+        THEN("They can be read back, oldest first")
+        {
+            tracing::timeline::Snapshot snapshot;
+            REQUIRE(snapshot.size() == 2);
+            tracing::TimedEvent event;
+            REQUIRE(snapshot.get(0, event));
+            CHECK(event.action == tracing::Action::UPDATE_OBJECT);
+            CHECK(event.id == 100);
+            CHECK(event.type == 1000);
+            CHECK(event.start == 50);
+            CHECK(event.duration == 10);
+            REQUIRE(snapshot.get(1, event));
+            CHECK(event.action == tracing::Action::READ_OBJECT);
+            CHECK_FALSE(snapshot.get(2, event));
+        }
+
+        THEN("They can be streamed in binary format")
+        {
+            uint8_t buffer[100] = {0};
+            BufferDataOut out(buffer, sizeof(buffer));
+            CHECK(tracing::streamTimelineTo(out));
+            CHECK(out.bytesWritten() == 2 + 2 * 13);
+            BufferDataIn in(buffer, out.bytesWritten());
+            uint16_t count = 0;
+            uint32_t start = 0;
+            uint32_t duration = 0;
+            uint8_t action = 0;
+            uint16_t id = 0;
+            uint16_t type = 0;
+            in.get(count);
+            in.get(start);
+            in.get(duration);
+            in.get(action);
+            in.get(id);
+            in.get(type);
+            CHECK(count == 2);
+            CHECK(start == 50);
+            CHECK(duration == 10);
+            CHECK(action == tracing::Action::UPDATE_OBJECT);
+            CHECK(id == 100);
+            CHECK(type == 1000);
+        }
+
+        THEN("They can be exported in Chrome trace format, with timestamps relative to the first event")
+        {
+            std::stringstream ss;
+            OStreamDataOut out(ss);
+            tracing::writeChromeTrace(out);
+            CHECK(ss.str() == "{\"traceEvents\":["
+                              "\n{\"name\":\"UPDATE_OBJECT\",\"ph\":\"X\",\"ts\":0,\"dur\":10,\"pid\":1,\"tid\":1,\"args\":{\"id\":100,\"type\":1000}},"
+                              "\n{\"name\":\"READ_OBJECT\",\"ph\":\"X\",\"ts\":20,\"dur\":5,\"pid\":1,\"tid\":1,\"args\":{\"id\":101,\"type\":1001}}"
+                              "\n]}\n");
+        }
+    }
+
+    WHEN("More events are recorded than fit in the timeline")
+    {
+        for (uint32_t i = 0; i < tracing::timeline::capacity() + 10; i++) {
+            tracing::timeline::record(200, 0, 0, i, 1);
+        }
+
+        THEN("The oldest events are overwritten")
+        {
+            tracing::timeline::Snapshot snapshot;
+            REQUIRE(snapshot.size() == tracing::timeline::capacity());
+            tracing::TimedEvent event;
+            REQUIRE(snapshot.get(0, event));
+            CHECK(event.start == 10);
+            REQUIRE(snapshot.get(tracing::timeline::capacity() - 1, event));
+            CHECK(event.start == tracing::timeline::capacity() + 9);
+        }
+
+        THEN("Events that are overwritten after a snapshot is taken are no longer returned")
+        {
+            tracing::timeline::Snapshot snapshot;
+            tracing::timeline::record(201, 0, 0, 1000, 1);
+            tracing::TimedEvent event;
+            CHECK_FALSE(snapshot.get(0, event));
+            REQUIRE(snapshot.get(1, event));
+            CHECK(event.start == 11);
+        }
+
+        THEN("Actions without a name are exported with their number")
+        {
+            std::stringstream ss;
+            OStreamDataOut out(ss);
+            tracing::writeChromeTrace(out);
+            CHECK(ss.str().find("{\"name\":\"200\"") != std::string::npos);
+        }
+    }
+
+    WHEN("Actions are traced by two threads at the same time")
+    {
+        auto recordMany = [](uint8_t action) {
+            for (uint32_t i = 0; i < 10000; i++) {
+                tracing::timeline::record(action, action, action, i, 1);
+            }
+        };
+        std::thread other(recordMany, 201);
+        recordMany(202);
+        other.join();
+
+        THEN("Each event is recorded as a whole")
+        {
+            tracing::timeline::Snapshot snapshot;
+            REQUIRE(snapshot.size() == tracing::timeline::capacity());
+            for (size_t i = 0; i < snapshot.size(); i++) {
+                tracing::TimedEvent event;
+                if (!snapshot.get(i, event)) {
+                    continue; // dropped because both threads wrote the same entry
+                }
+                CHECK((event.action == 201 || event.action == 202));
+                CHECK(event.id == event.action);
+                CHECK(event.type == event.action);
+                CHECK(event.duration == 1);
+            }
+        }
+    }
+
+    WHEN("Actions are added to the crash history by two threads at the same time")
+    {
+        auto addMany = [](uint8_t action) {
+            for (uint32_t i = 0; i < 10000; i++) {
+                tracing::add(action, action, action);
+            }
+        };
+        tracing::unpause();
+        std::thread other(addMany, 201);
+        addMany(202);
+        other.join();
+        tracing::pause();
+
+        THEN("Each entry is added as a whole")
+        {
+            for (const auto& event : tracing::history()) {
+                CHECK((event.action == 201 || event.action == 202));
+                CHECK(event.id == event.action);
+                CHECK(event.type == event.action);
+            }
+        }
+    }
+
+    WHEN("An action is traced with a scope")
+    {
+        tracing::unpause();
+        {
+            tracing::Scope<tracing::OBJECT_STORAGE> trace(tracing::Action::PERSIST_OBJECT, 123, 456);
+        }
+        tracing::pause();
+
+        THEN("It is added to the crash history when it starts")
+        {
+            auto last = tracing::history().back();
+            CHECK(last.action == tracing::Action::PERSIST_OBJECT);
+            CHECK(last.id == 123);
+            CHECK(last.type == 456);
+        }
+
+        THEN("It is recorded in the timeline when it ends")
+        {
+            tracing::timeline::Snapshot snapshot;
+            REQUIRE(snapshot.size() == 1);
+            tracing::TimedEvent event;
+            REQUIRE(snapshot.get(0, event));
+            CHECK(event.action == tracing::Action::PERSIST_OBJECT);
+            CHECK(event.id == 123);
+            CHECK(event.type == 456);
+        }
+    }
+}
+
+SCENARIO("Traced actions can be filtered by category")
+{
+    tracing::timeline::clear();
+    tracing::unpause();
+    tracing::add(tracing::Action::NONE);
+
+    WHEN("The default categories are enabled")
+    {
+        tracing::setCategories(tracing::defaultCategories());
+        {
+            tracing::Scope<tracing::OBJECT_UPDATES> trace(tracing::Action::UPDATE_OBJECT, 123, 456);
+        }
+        tracing::add<tracing::OBJECT_UPDATES>(tracing::Action::STREAM_TO_OBJECT, 123, 456);
+
+        THEN("Per object updates are not traced")
+        {
+            CHECK(tracing::enabled<tracing::OBJECT_UPDATES>() == false);
+            CHECK(tracing::history().back().action == tracing::Action::NONE);
+            CHECK(tracing::timeline::Snapshot().size() == 0);
+        }
+
+        THEN("Other categories are traced")
+        {
+            tracing::add<tracing::OBJECT_STORAGE>(tracing::Action::CONSTRUCT_OBJECT, 123, 456);
+            {
+                tracing::Scope<tracing::COMMANDS> trace(tracing::Action::READ_OBJECT);
+            }
+            CHECK(tracing::history().back().action == tracing::Action::READ_OBJECT);
+            tracing::timeline::Snapshot snapshot;
+            REQUIRE(snapshot.size() == 1);
+            tracing::TimedEvent event;
+            REQUIRE(snapshot.get(0, event));
+            CHECK(event.action == tracing::Action::READ_OBJECT);
+        }
+    }
+
+    WHEN("All categories are enabled")
+    {
+        tracing::setCategories(tracing::ALL_CATEGORIES);
+        {
+            tracing::Scope<tracing::OBJECT_UPDATES> trace(tracing::Action::UPDATE_OBJECT, 123, 456);
+        }
+
+        THEN("Per object updates are traced")
+        {
+            CHECK(tracing::history().back().action == tracing::Action::UPDATE_OBJECT);
+            CHECK(tracing::timeline::Snapshot().size() == 1);
+        }
+    }
+
+    WHEN("No categories are enabled")
+    {
+        tracing::setCategories(0);
+        {
+            tracing::Scope<tracing::COMMANDS> trace(tracing::Action::READ_OBJECT);
+        }
+
+        THEN("Nothing is traced")
+        {
+            CHECK(tracing::categories() == 0);
+            CHECK(tracing::history().back().action == tracing::Action::NONE);
+            CHECK(tracing::timeline::Snapshot().size() == 0);
+        }
+    }
+
+    tracing::setCategories(tracing::defaultCategories());
+    tracing::pause();
+}
@@ -7,6 +7,7 @@
 #include "Tracing.h"
 #include "testinfo.h"
 #include <catch.hpp>
+#include <chrono>
 
 TestInfo testInfo;
 
@@ -22,6 +23,12 @@ connectionStarted(DataOut& out)
 {
 }
 
+uint32_t
+clockMicros()
+{
+    return uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
 bool
 applicationCommand(uint8_t cmdId, DataIn& in, EncodedDataOut& out)
 {
@@ -21,7 +21,7 @@
 
 #include "ActuatorDigitalBase.h"
 #include "TicksTypes.h"
-#include <array>
+#include <vector>
 /*
  * An ActuatorDigitalBase wrapper that logs the most recent changes
  */
@@ -35,16 +35,28 @@ public:
         ticks_millis_t startTime;
     };
 
+    struct Durations {
+        ticks_millis_t currentActive;
+        ticks_millis_t currentPeriod;
+        ticks_millis_t previousActive;
+        ticks_millis_t previousPeriod;
+        State lastState;
+    };
+
 private:
     ActuatorDigitalBase& actuator;
-    std::array<StateChange, 5> history; // uneven length makes last entry equal to first for toggling (PWM) behavior
+    std::vector<StateChange> history; // uneven length makes last entry equal to first for toggling (PWM) behavior
+    Durations completedDurations;       // durations of all history entries except the most recent one, updated on each state change
+
+    void updateCompletedDurations();
 
 protected:
     ticks_millis_t lastUpdateTime = 0;
 
 public:
-    ActuatorDigitalChangeLogged(ActuatorDigitalBase& act)
+    ActuatorDigitalChangeLogged(ActuatorDigitalBase& act, uint8_t historyLength = 5)
         : actuator(act)
+        , history(historyLength > 0 ? historyLength : 1)
     {
         resetHistory();
     }
@@ -70,16 +82,14 @@ public:
 
     StartEnd getLastStartEndTime(const State& state, const ticks_millis_t& now) const;
 
-    struct Durations {
-        ticks_millis_t currentActive;
-        ticks_millis_t currentPeriod;
-        ticks_millis_t previousActive;
-        ticks_millis_t previousPeriod;
-        State lastState;
-    };
-    Durations activeDurations(const ticks_millis_t& now);
+    Durations activeDurations(const ticks_millis_t& now) const;
 
     void resetHistory();
 
+    size_t historyLength() const
+    {
+        return history.size();
+    }
+
     bool supportsFastIo() const;
 };
@@ -52,6 +52,13 @@ public:
         return m_timeRemaining;
     }
 
+    // Time after the last call to allowed() before its answer can change, for the same requested state.
+    // Timer based constraints are exact. Constraints that depend on other objects can return 0 to be asked every time.
+    virtual duration_millis_t nextDecision() const
+    {
+        return m_timeRemaining;
+    }
+
     duration_millis_t allowed(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act)
     {
         m_timeRemaining = allowedImpl(newState, now, act);
@@ -71,9 +78,16 @@ private:
     std::vector<std::unique_ptr<Constraint>> constraints;
     State m_desiredState = State::Inactive;
 
+    // when a constraint blocks a state change, it is not asked again until it can make a different decision
+    Constraint* m_blockedBy = nullptr;
+    State m_blockedState = State::Inactive;
+    ticks_millis_t m_blockedSince = 0;
+    duration_millis_t m_blockedRemaining = 0;
+    duration_millis_t m_blockedRecheck = 0;
+
 public:
-    ActuatorDigitalConstrained(ActuatorDigitalBase& act)
-        : ActuatorDigitalChangeLogged(act)
+    ActuatorDigitalConstrained(ActuatorDigitalBase& act, uint8_t historyLength = 5)
+        : ActuatorDigitalChangeLogged(act, historyLength)
     {
     }
 
@@ -93,6 +107,7 @@ public:
 
     void addConstraint(std::unique_ptr<Constraint>&& newConstraint)
     {
+        m_blockedBy = nullptr;
         if (constraints.size() < 8) {
             constraints.push_back(std::move(newConstraint));
         }
@@ -103,6 +118,7 @@ public:
     // remove all constraints and return vector of removed constraints
     auto removeAllConstraints()
     {
+        m_blockedBy = nullptr;
         auto oldConstraints = std::move(constraints);
         constraints = std::vector<std::unique_ptr<Constraint>>();
         return oldConstraints;
@@ -110,14 +126,30 @@ public:
 
     void resetHistory()
     {
+        m_blockedBy = nullptr;
         ActuatorDigitalChangeLogged::resetHistory();
     }
 
     duration_millis_t checkConstraints(const State& val, const ticks_millis_t& now)
     {
+        if (m_blockedBy && val == m_blockedState) {
+            auto elapsed = now - m_blockedSince;
+            if (elapsed < m_blockedRecheck) {
+                auto remaining = m_blockedRemaining - elapsed;
+                m_blockedBy->timeRemaining(remaining);
+                return remaining;
+            }
+        }
+        m_blockedBy = nullptr;
         for (auto& c : constraints) {
             auto remaining = c->allowed(val, now, *this);
             if (remaining > 0) {
+                // constraints are still checked at least once per second
+                m_blockedBy = c.get();
+                m_blockedState = val;
+                m_blockedSince = now;
+                m_blockedRemaining = remaining;
+                m_blockedRecheck = std::min(c->nextDecision(), duration_millis_t(1000));
                 return remaining;
             }
         }
@@ -147,6 +179,7 @@ public:
 
     void setStateUnlogged(const State& val)
     {
+        m_blockedBy = nullptr;
         m_desiredState = val;
         ActuatorDigitalChangeLogged::state(val);
     }
@@ -470,6 +503,12 @@ public:
         return bool(m_lock);
     }
 
+    // the owner of the lock can release it at any time
+    virtual duration_millis_t nextDecision() const override final
+    {
+        return 0;
+    }
+
     virtual uint8_t
     id() const override final
     {
@@ -20,12 +20,18 @@
 #pragma once
 #include "FilterChain.h"
 #include "FixedPoint.h"
+#include "TicksTypes.h"
 #include <type_traits>
 
 template <typename T>
 class FpFilterChain {
 private:
     FilterChain chain;
+    duration_millis_t m_sampleInterval = 1000; // time between added samples
+    uint16_t m_decimation = 1;                 // number of samples averaged into one chain input
+    uint16_t m_pending = 0;                    // samples accumulated since the last chain input
+    int64_t m_pendingSum = 0;
+    int32_t m_lastInput = 0;
 
 public:
     using value_type = T;
@@ -40,7 +46,17 @@ public:
 
     void add(value_type val)
     {
-        chain.add(cnl::unwrap(val));
+        m_lastInput = cnl::unwrap(val);
+        if (m_decimation <= 1) {
+            chain.add(m_lastInput);
+            return;
+        }
+        m_pendingSum += m_lastInput;
+        if (++m_pending >= m_decimation) {
+            chain.add(int32_t(m_pendingSum / m_pending));
+            m_pending = 0;
+            m_pendingSum = 0;
+        }
     }
     void add(int32_t val);
 
@@ -61,7 +77,7 @@ public:
 
     value_type readLastInput() const
     {
-        return cnl::wrap<value_type>(chain.readLastInput());
+        return cnl::wrap<value_type>(m_lastInput);
     }
 
     uint8_t length() const
@@ -69,18 +85,55 @@ public:
         return chain.length();
     }
 
-    // get the derivative from the chain with max precision and convert to the requested FP precision
+    duration_millis_t sampleInterval() const
+    {
+        return m_sampleInterval;
+    }
+
+    void sampleInterval(duration_millis_t v)
+    {
+        m_sampleInterval = v > 0 ? v : 1;
+        m_decimation = decimation(m_sampleInterval);
+        m_pending = 0;
+        m_pendingSum = 0;
+    }
+
+    // samples shorter than a second are averaged, so the chain is updated about once per second
+    // and the delay of each stage stays the same in seconds
+    static uint16_t decimation(duration_millis_t sampleInterval)
+    {
+        return sampleInterval < 1000 ? uint16_t((1000 + sampleInterval - 1) / sampleInterval) : 1;
+    }
+
+    // time between samples added to the chain
+    static duration_millis_t filterInterval(duration_millis_t sampleInterval)
+    {
+        sampleInterval = sampleInterval > 0 ? sampleInterval : 1;
+        return sampleInterval * decimation(sampleInterval);
+    }
+
+    duration_millis_t filterInterval() const
+    {
+        return m_sampleInterval * m_decimation;
+    }
+
+    // get the derivative per second from the chain with max precision and convert to the requested FP precision
     template <typename U>
     U readDerivative(uint8_t filterIdx = 255, bool smooth = true) const
     {
         auto derivative = chain.readDerivative(filterIdx, smooth);
         uint8_t destFractionBits = cnl::_impl::fractional_digits<U>::value;
         uint8_t filterFactionBits = cnl::_impl::fractional_digits<T>::value + derivative.fractionBits;
-        int64_t result;
+        int64_t result = derivative.result;
+        auto interval = filterInterval();
+        if (interval != 1000) {
+            // the chain returns the change per chain sample, scale it to the change per second
+            result = (result * 1000) / int32_t(interval);
+        }
         if (destFractionBits >= filterFactionBits) {
-            result = derivative.result << (destFractionBits - filterFactionBits);
+            result = result << (destFractionBits - filterFactionBits);
         } else {
-            result = derivative.result >> (filterFactionBits - destFractionBits);
+            result = result >> (filterFactionBits - destFractionBits);
         }
         return cnl::wrap<U>(result);
     }
@@ -95,6 +148,9 @@ public:
     reset(value_type value)
     {
         chain.reset(cnl::unwrap(value));
+        m_lastInput = cnl::unwrap(value);
+        m_pending = 0;
+        m_pendingSum = 0;
     }
 
     void
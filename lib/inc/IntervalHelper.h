@@ -22,32 +22,48 @@
 #include "TicksTypes.h"
 
 /*
- * A process value has a setting and an current value
+ * Keeps track of when a periodic update is due, making up for updates that were late.
+ * The interval is a runtime setting, so blocks can run faster or slower than once per second.
  */
-template <ticks_millis_t INTERVAL>
 class IntervalHelper {
 private:
+    duration_millis_t m_interval;
     duration_millis_t m_accumulatedUpdateLateness = 0;
-    ticks_millis_t m_lastUpdate = -INTERVAL;
+    ticks_millis_t m_lastUpdate;
 
 public:
-    IntervalHelper() = default;
+    explicit IntervalHelper(duration_millis_t interval = 1000)
+        : m_interval(interval)
+        , m_lastUpdate(-interval)
+    {
+    }
     IntervalHelper(const IntervalHelper&) = delete;
     IntervalHelper& operator=(const IntervalHelper&) = delete;
     ~IntervalHelper() = default;
 
+    duration_millis_t interval() const
+    {
+        return m_interval;
+    }
+
+    void interval(duration_millis_t v)
+    {
+        m_interval = v;
+        m_accumulatedUpdateLateness = 0;
+    }
+
     ticks_millis_t update(const ticks_millis_t& now, bool& doUpdate)
     {
-        // interval is max 1000ms. Can be shortened to make up for previous updates that were overdue
-        auto interval = m_accumulatedUpdateLateness >= INTERVAL ? 0 : INTERVAL - m_accumulatedUpdateLateness;
+        // interval can be shortened to make up for previous updates that were overdue
+        auto interval = m_accumulatedUpdateLateness >= m_interval ? 0 : m_interval - m_accumulatedUpdateLateness;
         auto elapsed = now - m_lastUpdate;
 
         if (elapsed >= interval) {
             doUpdate = true;
             m_lastUpdate = now;
             m_accumulatedUpdateLateness += elapsed;
-            m_accumulatedUpdateLateness = m_accumulatedUpdateLateness > INTERVAL ? m_accumulatedUpdateLateness - INTERVAL : 0;
-            interval = m_accumulatedUpdateLateness >= INTERVAL ? 0 : INTERVAL - m_accumulatedUpdateLateness;
+            m_accumulatedUpdateLateness = m_accumulatedUpdateLateness > m_interval ? m_accumulatedUpdateLateness - m_interval : 0;
+            interval = m_accumulatedUpdateLateness >= m_interval ? 0 : m_interval - m_accumulatedUpdateLateness;
             return now + interval;
         }
         return now + interval - elapsed;
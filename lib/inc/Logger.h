@@ -19,18 +19,26 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <functional>
-#include <memory>
-#include <string>
 
+// maximum length of a log message, longer messages are truncated
+#ifndef CL_LOG_MAX_LENGTH
+#define CL_LOG_MAX_LENGTH 80
+#endif
+
+static_assert(CL_LOG_MAX_LENGTH < 256, "the length of a log message is stored in a uint8_t");
+
+/**
+ * Logger that formats messages in a fixed size buffer on the stack, so logging never allocates.
+ * Messages longer than CL_LOG_MAX_LENGTH are truncated.
+ *
+ * The CL_LOG_* macros give each call site its own rate limit.
+ * When a clock is provided, a call site logs at most burst() messages per window().
+ * The number of suppressed messages is appended to the next message that is logged.
+ */
 class Logger {
 public:
-    Logger() = default;
-    ~Logger() = default;
-    Logger(const Logger&) = delete;
-    Logger& operator=(const Logger&) = delete;
-
     enum LogLevel : uint8_t {
         DEBUG,
         INFO,
@@ -38,30 +46,188 @@ public:
         ERROR
     };
 
-    using LogWriteFunction = std::function<void(const LogLevel& logLevel, const std::string&)>;
-    using StringBuffer = std::unique_ptr<std::string, std::function<void(std::string*)>>;
+    using LogWriteFunction = void (*)(LogLevel logLevel, const char* message, size_t length);
+    using ClockFunction = uint32_t (*)(); // milliseconds
+
+    static constexpr size_t maxLength()
+    {
+        return CL_LOG_MAX_LENGTH;
+    }
+
+    static constexpr uint8_t burst()
+    {
+        return 5;
+    }
+
+    static constexpr uint32_t window()
+    {
+        return 10000;
+    }
+
+    // state of the rate limit of a single call site
+    class RateLimit {
+    public:
+        RateLimit() = default;
+
+    private:
+        friend class Logger;
+        uint32_t windowStart = 0;
+        uint8_t count = 0;
+        uint16_t suppressed = 0;
+    };
+
+    /**
+     * A message that is being formatted. It is written to the log when it goes out of scope.
+     */
+    class Message {
+    public:
+        Message(Logger* logger, LogLevel level, const char* initStr)
+            : m_logger(logger)
+            , m_level(level)
+        {
+            *this << initStr;
+        }
+
+        Message(Message&& other)
+            : m_logger(other.m_logger)
+            , m_level(other.m_level)
+            , m_length(other.m_length)
+            , m_suppressed(other.m_suppressed)
+        {
+            for (size_t i = 0; i < m_length; i++) {
+                m_buffer[i] = other.m_buffer[i];
+            }
+            other.m_logger = nullptr;
+        }
+
+        Message(const Message&) = delete;
+        Message& operator=(const Message&) = delete;
+        Message& operator=(Message&&) = delete;
+
+        ~Message()
+        {
+            if (m_logger) {
+                if (m_suppressed) {
+                    *this << " (" << uint32_t(m_suppressed) << " suppressed)";
+                }
+                m_buffer[m_length] = 0;
+                m_logger->m_logWriteFunction(m_level, m_buffer, m_length);
+            }
+        }
+
+        Message& operator<<(const char* str)
+        {
+            if (m_logger && str) {
+                while (*str && m_length < maxLength()) {
+                    m_buffer[m_length++] = *str++;
+                }
+            }
+            return *this;
+        }
+
+        Message& operator<<(uint32_t value)
+        {
+            char digits[10];
+            uint8_t n = 0;
+            do {
+                digits[n++] = '0' + value % 10;
+                value /= 10;
+            } while (value > 0);
+            while (n > 0) {
+                append(digits[--n]);
+            }
+            return *this;
+        }
+
+        Message& operator<<(int32_t value)
+        {
+            if (value < 0) {
+                append('-');
+                return *this << (~uint32_t(value) + 1);
+            }
+            return *this << uint32_t(value);
+        }
+
+        // append a byte as 2 uppercase hex characters
+        Message& appendHex(uint8_t value)
+        {
+            append(hexDigit(value >> 4));
+            append(hexDigit(value & 0x0F));
+            return *this;
+        }
+
+    private:
+        friend class Logger;
+
+        void append(char c)
+        {
+            if (m_logger && m_length < maxLength()) {
+                m_buffer[m_length++] = c;
+            }
+        }
 
-    explicit Logger(LogWriteFunction&& logFunction)
+        static char hexDigit(uint8_t v)
+        {
+            return v > 9 ? v - 10 + 'A' : v + '0';
+        }
+
+        Logger* m_logger;
+        LogLevel m_level;
+        uint8_t m_length = 0;
+        uint16_t m_suppressed = 0;
+        char m_buffer[CL_LOG_MAX_LENGTH + 1];
+    };
+
+    explicit Logger(LogWriteFunction logFunction, ClockFunction clock = nullptr)
         : m_logWriteFunction(logFunction)
+        , m_clock(clock)
+    {
+    }
+    ~Logger() = default;
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    Message operator()(LogLevel level, const char* initStr)
     {
+        return Message(this, level, initStr);
     }
 
-    StringBuffer operator()(LogLevel e, std::string&& initStr)
+    // a message that is not logged when the call site exceeded its rate limit
+    Message operator()(LogLevel level, RateLimit& limit, const char* initStr)
     {
-        return StringBuffer(new std::string(initStr), [e, this](std::string* st) {
-            m_logWriteFunction(e, *st);
-            delete st;
-        });
+        if (!m_clock) {
+            return Message(this, level, initStr);
+        }
+        uint32_t now = m_clock();
+        if (limit.count == 0 || now - limit.windowStart >= window()) {
+            limit.windowStart = now;
+            limit.count = 0;
+        }
+        if (limit.count >= burst()) {
+            if (limit.suppressed < UINT16_MAX) {
+                ++limit.suppressed;
+            }
+            return Message(nullptr, level, initStr);
+        }
+        ++limit.count;
+        Message msg(this, level, initStr);
+        msg.m_suppressed = limit.suppressed;
+        limit.suppressed = 0;
+        return msg;
     }
 
 private:
     LogWriteFunction m_logWriteFunction;
+    ClockFunction m_clock;
 };
 
 extern Logger&
 logger();
 
-#define CL_LOG_DEBUG(initStr) *logger()(Logger::DEBUG, initStr)
-#define CL_LOG_INFO(initStr) *logger()(Logger::INFO, initStr)
-#define CL_LOG_WARN(initStr) *logger()(Logger::WARN, initStr)
-#define CL_LOG_ERROR(initStr) *logger()(Logger::ERROR, initStr)
+// every call site has its own rate limit, defined as a static inside a lambda that is unique to the call site
+#define CL_LOG_RATE_LIMIT() ([]() -> Logger::RateLimit& { static Logger::RateLimit limit; return limit; }())
+
+#define CL_LOG_DEBUG(initStr) logger()(Logger::DEBUG, CL_LOG_RATE_LIMIT(), initStr)
+#define CL_LOG_INFO(initStr) logger()(Logger::INFO, CL_LOG_RATE_LIMIT(), initStr)
+#define CL_LOG_WARN(initStr) logger()(Logger::WARN, CL_LOG_RATE_LIMIT(), initStr)
+#define CL_LOG_ERROR(initStr) logger()(Logger::ERROR, CL_LOG_RATE_LIMIT(), initStr)
@@ -20,7 +20,9 @@
 #pragma once
 
 #include "ProcessValue.h"
+#include "Seqlock.h"
 #include "SetpointSensorPair.h"
+#include "TicksTypes.h"
 #include <cstring>
 #include <functional>
 
@@ -31,6 +33,18 @@ public:
     using integral_t = safe_elastic_fixed_point<18, 12>;
     using derivative_t = SetpointSensorPair::derivative_t;
 
+    // runtime state that is published after each update, see state()
+    struct State {
+        in_t error;
+        out_t p;
+        out_t i;
+        out_t d;
+        integral_t integral;
+        derivative_t derivative;
+        bool active;
+        bool boilModeActive;
+    };
+
 private:
     const std::function<std::shared_ptr<SetpointSensorPair>()> m_inputPtr;
     const std::function<std::shared_ptr<ProcessValue<out_t>>()> m_outputPtr;
@@ -43,6 +57,7 @@ private:
     integral_t m_integral = integral_t{0};
     derivative_t m_derivative = derivative_t{0};
     uint8_t m_derivativeFilterNr = 0;
+    duration_millis_t m_derivativeFilterInterval = 0; // input filter interval for which the filter was selected
 
     // settings
     in_t m_kp = in_t{0};    // proportional gain
@@ -51,12 +66,16 @@ private:
     bool m_enabled = false; // persisted setting to manually disable the pid
     bool m_active = false;  // automatically set when input is invalid
 
+    duration_millis_t m_interval = 1000; // time between calls to update()
+
     in_t m_boilPointAdjust = in_t{0}; // offset from 100C for lower limit to activate boil mode
 
     out_t m_boilMinOutput = out_t{0}; // minimum output when boiling (to control boil intensity)
 
     bool m_boilModeActive = false;
 
+    Seqlock<State> m_snapshot;
+
 public:
     explicit Pid(
         std::function<std::shared_ptr<SetpointSensorPair>()>&& input,
@@ -75,6 +94,15 @@ public:
 
     void update();
 
+    /**
+     * Consistent copy of the state fields, as published at the end of the last update.
+     * It can be read from another thread than the one that updates the pid, without locking.
+     */
+    State state() const
+    {
+        return m_snapshot.read();
+    }
+
     // state
     auto error() const
     {
@@ -128,6 +156,16 @@ public:
 
     void td(const uint16_t& arg);
 
+    auto updateInterval() const
+    {
+        return m_interval;
+    }
+
+    void updateInterval(duration_millis_t v)
+    {
+        m_interval = v > 0 ? v : 1;
+    }
+
     void enabled(bool state)
     {
         active(state);
@@ -187,4 +225,9 @@ private:
         m_active = state;
     }
     void checkFilterLength();
+    void calculate();
+    void publish()
+    {
+        m_snapshot.publish(State{m_error, m_p, m_i, m_d, m_integral, m_derivative, m_active, m_boilModeActive});
+    }
 };
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "FpFilterChain.h"
+#include "TempSensor.h"
+#include "Temperature.h"
+#include "TicksTypes.h"
+#include <limits>
+#include <memory>
+#include <vector>
+
+/*
+ * Filtered values of temperature sensors, shared by all consumers that filter the same sensor with the same settings.
+ * Each sensor is only filtered once per sample, no matter how many setpoint/sensor pairs use it.
+ *
+ * The cache only holds weak references. An entry is freed when the last consumer releases it.
+ * It is not thread safe and should only be used from the thread that updates the blocks.
+ */
+class SensorFilterCache {
+public:
+    struct Settings {
+        int32_t stepThreshold = std::numeric_limits<int32_t>::max(); // raw temp_t, default disables step detection
+        duration_millis_t sampleInterval = 1000;
+
+        bool operator==(const Settings& other) const
+        {
+            return stepThreshold == other.stepThreshold && sampleInterval == other.sampleInterval;
+        }
+    };
+
+    class Entry {
+    private:
+        std::weak_ptr<TempSensor> m_sensor;
+        Settings m_settings;
+        FpFilterChain<temp_t> m_filter;
+        uint32_t m_samples = 0;
+        uint8_t m_sensorFailureCount = 255; // force a reset on first update
+
+    public:
+        Entry(const std::shared_ptr<TempSensor>& sensor, const Settings& settings)
+            : m_sensor(sensor)
+            , m_filter(1)
+        {
+            configure(settings);
+        }
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+        ~Entry() = default;
+
+        const FpFilterChain<temp_t>& filter() const
+        {
+            return m_filter;
+        }
+
+        const Settings& settings() const
+        {
+            return m_settings;
+        }
+
+        bool sensorIs(const std::shared_ptr<TempSensor>& sensor) const
+        {
+            return m_sensor.lock() == sensor;
+        }
+
+        // number of samples added, consumers keep their own count to add each sample only once
+        uint32_t samples() const
+        {
+            return m_samples;
+        }
+
+        bool valueValid() const
+        {
+            return m_sensorFailureCount <= 10;
+        }
+
+        void configure(const Settings& settings);
+
+        /*
+         * Adds a sample of the sensor, unless another consumer already added it.
+         * consumerSamples is the sample count of the consumer, it is updated to the count of the entry.
+         */
+        void update(uint32_t& consumerSamples, const std::shared_ptr<TempSensor>& sensor);
+
+        void reset(const temp_t& value);
+
+        void expandStages(uint8_t numStages)
+        {
+            m_filter.expandStages(numStages);
+        }
+    };
+
+private:
+    std::vector<std::weak_ptr<Entry>> entries;
+
+public:
+    SensorFilterCache() = default;
+    SensorFilterCache(const SensorFilterCache&) = delete;
+    SensorFilterCache& operator=(const SensorFilterCache&) = delete;
+    ~SensorFilterCache() = default;
+
+    // returns the entry for the sensor with these settings, or null if no consumer uses it
+    std::shared_ptr<Entry> find(const std::shared_ptr<TempSensor>& sensor, const Settings& settings);
+
+    // returns the entry for the sensor with these settings, or a new entry if no consumer uses it yet
+    std::shared_ptr<Entry> acquire(const std::shared_ptr<TempSensor>& sensor, const Settings& settings);
+
+    // returns a new entry, even if other consumers use an entry for the sensor with these settings
+    std::shared_ptr<Entry> create(const std::shared_ptr<TempSensor>& sensor, const Settings& settings);
+
+    // number of entries that are in use
+    size_t size() const;
+};
+
+// cache shared by all setpoint/sensor pairs
+SensorFilterCache& sensorFilterCache();
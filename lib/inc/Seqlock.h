@@ -0,0 +1,101 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewBlox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Holds a copy of a trivially copyable value that one writer publishes and any thread can read without locking.
+ * The writer never waits. A reader retries when the value was published while it was copied,
+ * so it always gets a value that was published as a whole.
+ *
+ * The value is stored in atomic words, so concurrent reads and writes are not a data race.
+ */
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock can only hold trivially copyable types");
+
+private:
+    static constexpr size_t numWords()
+    {
+        return (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    }
+
+    std::atomic<uint32_t> sequence{0}; // odd while the writer is publishing
+    std::array<std::atomic<uint32_t>, numWords()> words;
+
+public:
+    Seqlock()
+    {
+        uint32_t buffer[numWords()] = {0};
+        T value{};
+        memcpy(buffer, &value, sizeof(T));
+        for (size_t i = 0; i < numWords(); ++i) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+    }
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    // may only be called by a single writer
+    void publish(const T& value)
+    {
+        uint32_t buffer[numWords()] = {0};
+        memcpy(buffer, &value, sizeof(T));
+
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < numWords(); ++i) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    T read() const
+    {
+        uint32_t buffer[numWords()];
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < numWords(); ++i) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        T value;
+        memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    // number of times a value was published
+    uint32_t version() const
+    {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+};
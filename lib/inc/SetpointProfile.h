@@ -22,27 +22,116 @@
 #include "SetpointSensorPair.h"
 #include "Temperature.h"
 #include "TicksTypes.h"
-#include <algorithm>
+#include <cstdint>
 #include <vector>
 
-class SetpointProfile {
+/**
+ * The points of a setpoint profile, stored delta encoded to use little RAM for long profiles.
+ * Each point is stored as the difference in time and temperature with the previous point, as zigzag encoded varints.
+ * A hold segment (no temperature change) takes 1 byte for the temperature, a ramp of a few degrees 2 or 3 bytes.
+ * Points are decoded in order with a Reader. Ranges of points can be read and written in pages.
+ */
+class ProfilePoints {
 public:
     struct Point {
         utc_seconds_t time;
         temp_t temp;
     };
 
+    class Reader {
+    private:
+        const uint8_t* pos;
+        const uint8_t* end;
+        Point last;
+
+    public:
+        Reader(const uint8_t* begin, const uint8_t* end_)
+            : pos(begin)
+            , end(end_)
+            , last{0, temp_t(0)}
+        {
+        }
+
+        // decodes the next point, returns false at the end of the list
+        bool next(Point& p);
+
+        const uint8_t* position() const
+        {
+            return pos;
+        }
+    };
+
+private:
+    std::vector<uint8_t> m_data;
+    Point m_last{0, temp_t(0)};
+    uint16_t m_size = 0;
+
+public:
+    void push_back(const Point& p);
+
+    void clear()
+    {
+        m_data.clear();
+        m_last = Point{0, temp_t(0)};
+        m_size = 0;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    // number of bytes used to store the points
+    size_t encodedSize() const
+    {
+        return m_data.size();
+    }
+
+    Reader reader() const
+    {
+        return Reader(m_data.data(), m_data.data() + m_data.size());
+    }
+
+    // copies at most maxCount points, starting at point first. Returns the number of points copied
+    size_t read(size_t first, Point* dest, size_t maxCount) const;
+
+    // replaces the points from point first onwards with count new points, earlier points are kept
+    void write(size_t first, const Point* src, size_t count);
+};
+
+class SetpointProfile {
+public:
+    using Point = ProfilePoints::Point;
+
 private:
+    // position in the profile of the last update, so the next update continues where the last one ended
+    struct Cursor {
+        ProfilePoints::Reader reader;
+        Point lower;
+        Point upper;
+        bool hasLower;
+        bool hasUpper;
+    };
+
     const std::function<std::shared_ptr<SetpointSensorPair>()> m_target;
     utc_seconds_t m_profileStartTime = 0;
     bool m_enabled = true;
 
-    std::vector<Point> m_points;
+    ProfilePoints m_points;
+    Cursor m_cursor;
+
+    void resetCursor();
 
 public:
     explicit SetpointProfile(
         std::function<std::shared_ptr<SetpointSensorPair>()>&& target) // process value to manipulate setpoint of
         : m_target(target)
+        , m_cursor{m_points.reader(), Point{0, temp_t(0)}, Point{0, temp_t(0)}, false, false}
     {
     }
     SetpointProfile(const SetpointProfile&) = delete;
@@ -51,12 +140,14 @@ public:
 
     void addPoint(Point&& p)
     {
-        m_points.push_back(std::move(p));
+        m_points.push_back(p);
+        resetCursor();
     }
 
     void removeAllPoints()
     {
         m_points.clear();
+        resetCursor();
     }
 
     bool isDriving() const
@@ -76,14 +167,26 @@ public:
         m_enabled = v;
     }
 
-    const std::vector<Point>& points() const
+    const ProfilePoints& points() const
     {
         return m_points;
     }
 
-    void points(std::vector<Point>&& newPoints)
+    void points(ProfilePoints&& newPoints)
+    {
+        m_points = std::move(newPoints);
+        resetCursor();
+    }
+
+    size_t readPoints(size_t first, Point* dest, size_t maxCount) const
+    {
+        return m_points.read(first, dest, maxCount);
+    }
+
+    void writePoints(size_t first, const Point* src, size_t count)
     {
-        m_points = newPoints;
+        m_points.write(first, src, count);
+        resetCursor();
     }
 
     utc_seconds_t startTime() const
@@ -94,5 +197,6 @@ public:
     void startTime(utc_seconds_t v)
     {
         m_profileStartTime = v;
+        resetCursor();
     }
 };
@@ -20,15 +20,18 @@
 #pragma once
 
 #include "FixedPoint.h"
-#include "FpFilterChain.h"
 #include "ProcessValue.h"
+#include "SensorFilterCache.h"
 #include "TempSensor.h"
 #include "Temperature.h"
+#include <algorithm>
 #include <functional>
 #include <memory>
 
 /*
  * A process value has a setting and an current value
+ * The sensor is filtered in a cache that is shared with other pairs that use the same sensor and filter settings.
+ * Each pair chooses which filter stage it reads.
  */
 class SetpointSensorPair : public ProcessValue<temp_t> {
 public:
@@ -38,15 +41,17 @@ private:
     temp_t m_setting = 20;
     bool m_settingEnabled = false;
     const std::function<std::shared_ptr<TempSensor>()> m_sensor;
-    FpFilterChain<temp_t> m_filter;
-    uint8_t m_sensorFailureCount = 255; // force a reset on init
-    uint8_t m_filterNr = 1;
+    std::shared_ptr<SensorFilterCache::Entry> m_filter; // null until the sensor is found
+    SensorFilterCache::Settings m_filterSettings;
+    uint32_t m_samples = 0;     // samples added by this pair, to add each sample to a shared filter only once
+    uint8_t m_filterNr = 1;     // filter choice, the stage with the same delay at a sample interval of 1 second
+    uint8_t m_filterStage = 1;  // filter stage that is read, with the delay of the filter choice at the sample interval
+    uint8_t m_filterStages = 1; // number of filter stages this pair needs
 
 public:
     explicit SetpointSensorPair(
         std::function<std::shared_ptr<TempSensor>()>&& _sensor)
         : m_sensor(_sensor)
-        , m_filter(1)
     {
         update();
     }
@@ -68,10 +73,13 @@ public:
 
     virtual temp_t value() const override final
     {
-        if (m_filterNr == 0) {
-            return m_filter.readLastInput();
+        if (!m_filter) {
+            return 0;
+        }
+        if (m_filterStage == 0) {
+            return m_filter->filter().readLastInput();
         }
-        return m_filter.read(m_filterNr - 1);
+        return m_filter->filter().read(m_filterStage - 1);
     }
 
     temp_t valueUnfiltered() const
@@ -85,7 +93,7 @@ public:
 
     bool valueValid() const override final
     {
-        return m_sensorFailureCount <= 10;
+        return m_filter && m_filter->valueValid();
     }
 
     bool sensorValid() const
@@ -113,12 +121,13 @@ public:
 
     auto filterThreshold() const
     {
-        return m_filter.getStepThreshold();
+        return cnl::wrap<temp_t>(m_filterSettings.stepThreshold);
     }
 
     void filterChoice(uint8_t choice)
     {
         m_filterNr = choice;
+        selectFilterStage();
     }
 
     auto filterThreshold(temp_t threshold)
@@ -126,22 +135,37 @@ public:
         if (threshold == 0) {
             threshold = 5;
         }
-        m_filter.setStepThreshold(threshold);
+        m_filterSettings.stepThreshold = cnl::unwrap(threshold);
+        filterSettingsChanged();
+    }
+
+    // time between calls to update(), the filters add one sample per update
+    duration_millis_t sampleInterval() const
+    {
+        return m_filterSettings.sampleInterval;
+    }
+
+    // time between samples of the filter chain, samples faster than a second are averaged
+    duration_millis_t filterInterval() const
+    {
+        return FpFilterChain<temp_t>::filterInterval(m_filterSettings.sampleInterval);
+    }
+
+    void sampleInterval(duration_millis_t v)
+    {
+        m_filterSettings.sampleInterval = v > 0 ? v : 1;
+        filterSettingsChanged();
+        selectFilterStage();
     }
 
     void update()
     {
-        if (sensorValid()) {
-            auto val = valueUnfiltered();
-            if (!valueValid()) {
-                m_filter.reset(val);
-            }
-            m_filter.add(val);
-            m_sensorFailureCount = 0;
-        } else {
-            if (m_sensorFailureCount < 255) {
-                m_sensorFailureCount++;
-            }
+        auto sensor = m_sensor();
+        if (sensor && (!m_filter || !m_filter->sensorIs(sensor))) {
+            attach(sensor);
+        }
+        if (m_filter) {
+            m_filter->update(m_samples, sensor);
         }
     }
 
@@ -150,29 +174,112 @@ public:
         return setting() - value();
     }
 
+    // derivative per second, independent of the sample interval
     auto readDerivative(uint8_t filterNr)
     {
         if (filterNr < 1) {
             filterNr = 1;
         }
-        return m_filter.readDerivative<derivative_t>(filterNr - 1);
+        if (!m_filter) {
+            return derivative_t{0};
+        }
+        return m_filter->filter().readDerivative<derivative_t>(filterNr - 1);
     }
 
-    auto filterLength()
+    uint8_t filterLength()
     {
-        return m_filter.length();
+        return m_filter ? m_filter->filter().length() : m_filterStages;
     }
 
-    auto resizeFilterIfNeeded(uint8_t filterNr)
+    void resizeFilterIfNeeded(uint8_t filterNr)
     {
-        m_filter.expandStages(filterNr);
+        m_filterStages = std::max(m_filterStages, filterNr);
+        if (m_filter) {
+            m_filter->expandStages(filterNr);
+        }
+    }
+
+    // switch to the filter of the current sensor without adding a sample
+    void updateSensor()
+    {
+        auto sensor = m_sensor();
+        if (sensor && (!m_filter || !m_filter->sensorIs(sensor))) {
+            attach(sensor);
+        }
     }
 
+    /*
+     * Restart the filter at the current sensor value.
+     * A shared filter is not reset, because other pairs keep their history. This pair continues with a filter of its own,
+     * until it attaches to a shared filter again when its sensor or filter settings change.
+     */
     void resetFilter()
     {
-        if (sensorValid()) {
-            m_filter.reset(valueUnfiltered());
-            m_sensorFailureCount = 0;
+        auto sensor = m_sensor();
+        if (sensor && sensor->valid()) {
+            if (!m_filter || !m_filter->sensorIs(sensor)) {
+                attach(sensor);
+            }
+            if (m_filter.use_count() > 1) {
+                m_filter = sensorFilterCache().create(sensor, m_filterSettings);
+                m_filter->expandStages(m_filterStages);
+                m_samples = m_filter->samples();
+            }
+            m_filter->reset(sensor->value());
+        }
+    }
+
+private:
+    // switch to the shared filter for the sensor and settings of this pair
+    void attach(const std::shared_ptr<TempSensor>& sensor)
+    {
+        m_filter = sensorFilterCache().acquire(sensor, m_filterSettings);
+        m_filter->expandStages(m_filterStages);
+        m_samples = m_filter->samples();
+        if (m_samples > 0) {
+            // the sample of this interval is already added by the pairs that use the entry, skip it until the next interval
+            --m_samples;
+        }
+        if (!m_filter->valueValid() && sensor->valid()) {
+            m_filter->reset(sensor->value());
+        }
+    }
+
+    // select the stage that filters over the same time in seconds as the filter choice at a sample interval of 1 second
+    void selectFilterStage()
+    {
+        // delay of each stage in samples, for a step input to reach half of the step
+        static constexpr uint16_t delays[6] = {8, 34, 85, 188, 492, 1428};
+        if (m_filterNr == 0) {
+            m_filterStage = 0;
+            return;
+        }
+        uint32_t delayMillis = uint32_t(delays[std::min(m_filterNr, uint8_t(6)) - 1]) * 1000;
+        auto interval = filterInterval();
+        m_filterStage = 1;
+        while (m_filterStage < 6) {
+            if (uint32_t(delays[m_filterStage - 1]) * interval >= delayMillis) {
+                break;
+            }
+            ++m_filterStage;
+        }
+        resizeFilterIfNeeded(m_filterStage);
+    }
+
+    void filterSettingsChanged()
+    {
+        if (!m_filter || m_filter->settings() == m_filterSettings) {
+            return;
+        }
+        auto sensor = m_sensor();
+        bool shared = m_filter.use_count() > 1;
+        if (sensor && (shared || sensorFilterCache().find(sensor, m_filterSettings))) {
+            attach(sensor);
+        } else if (!shared) {
+            // not shared, keep the filter history
+            m_filter->configure(m_filterSettings);
+        } else {
+            m_filter.reset();
         }
     }
 };
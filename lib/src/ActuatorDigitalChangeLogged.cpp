@@ -20,7 +20,6 @@
 #include "ActuatorDigitalChangeLogged.h"
 #include "TicksTypes.h"
 #include <algorithm>
-#include <array>
 #include <cstdint>
 
 using State = ActuatorDigitalBase::State;
@@ -57,6 +56,7 @@ ActuatorDigitalChangeLogged::update(const ticks_millis_t& now)
     if (current != history.front().newState) {
         std::move_backward(history.begin(), history.end() - 1, history.end());
         history[0] = {current, now};
+        updateCompletedDurations();
     }
     lastUpdateTime = now;
 }
@@ -82,7 +82,20 @@ ActuatorDigitalChangeLogged::getLastStartEndTime(const State& state, const ticks
 }
 
 ActuatorDigitalChangeLogged::Durations
-ActuatorDigitalChangeLogged::activeDurations(const ticks_millis_t& now)
+ActuatorDigitalChangeLogged::activeDurations(const ticks_millis_t& now) const
+{
+    // only the duration of the most recent state depends on the current time
+    Durations result = completedDurations;
+    auto duration = now - history.front().startTime;
+    result.currentPeriod += duration;
+    if (history.front().newState == State::Active) {
+        result.currentActive += duration;
+    }
+    return result;
+}
+
+void
+ActuatorDigitalChangeLogged::updateCompletedDurations()
 {
     Durations result;
 
@@ -91,7 +104,7 @@ ActuatorDigitalChangeLogged::activeDurations(const ticks_millis_t& now)
     result.previousActive = 0;
     result.previousPeriod = 0;
     result.lastState = history.front().newState;
-    auto end = now;
+    auto end = history.front().startTime; // the most recent state is added in activeDurations()
     auto start = ticks_millis_t(0);
     uint8_t activePeriods = 0;
 
@@ -129,15 +142,16 @@ ActuatorDigitalChangeLogged::activeDurations(const ticks_millis_t& now)
             }
         }
     }
-    return result;
+    completedDurations = result;
 }
 
 void
 ActuatorDigitalChangeLogged::resetHistory()
 {
-    history.fill(StateChange{State::Unknown, ticks_millis_t(-1)});
+    std::fill(history.begin(), history.end(), StateChange{State::Unknown, ticks_millis_t(-1)});
     history[0] = {actuator.state(), 0};
     lastUpdateTime = 0;
+    updateCompletedDurations();
 }
 
 bool
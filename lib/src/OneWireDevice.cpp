@@ -40,33 +40,25 @@ OneWireDevice::connected(bool _connected)
         return; // state stays the same
     }
 
-    std::string log;
-
+    const char* name;
     switch (m_address[0]) {
     case 0x28:
-        log += "Temp sensor ";
+        name = "Temp sensor ";
         break;
     case 0x3A:
-        log += "DS2413 ";
+        name = "DS2413 ";
         break;
     case 0x29:
-        log += "DS2408 ";
+        name = "DS2408 ";
         break;                    // LCOV_EXCL_LINE
     default:                      // LCOV_EXCL_LINE
-        log += "OneWire device "; // LCOV_EXCL_LINE
-    }
-
-    if (!_connected) {
-        log += "dis";
+        name = "OneWire device "; // LCOV_EXCL_LINE
     }
-    log += "connected: ";
-
-    log += m_address.toString();
 
-    if (_connected) {
-        CL_LOG_INFO(std::move(log));
-    } else {
-        CL_LOG_WARN(std::move(log));
+    auto log = _connected ? CL_LOG_INFO(name) : CL_LOG_WARN(name);
+    log << (_connected ? "connected: " : "disconnected: ");
+    for (uint8_t i = 0; i < 8; ++i) {
+        log.appendHex(m_address[i]);
     }
 
     m_connected = _connected;
@@ -20,8 +20,28 @@
 #include "../inc/Pid.h"
 #include "../inc/future_std.h"
 
+namespace {
+// the integral is kept in degree-seconds, scale an increase per second to the increase per update
+template <typename T>
+T
+scaleToInterval(const T& perSecond, duration_millis_t interval)
+{
+    if (interval == 1000) {
+        return perSecond;
+    }
+    return cnl::wrap<T>((int64_t(cnl::unwrap(perSecond)) * interval) / 1000);
+}
+}
+
 void
 Pid::update()
+{
+    calculate();
+    publish();
+}
+
+void
+Pid::calculate()
 {
     auto input = m_inputPtr();
     auto setpoint = in_t{0};
@@ -60,7 +80,7 @@ Pid::update()
 
     decltype(m_integral) integral_increase = 0;
     if (m_ti != 0 && m_kp != 0 && !m_boilModeActive) {
-        integral_increase = cnl::quotient(m_p + m_d, m_kp);
+        integral_increase = scaleToInterval(integral_t(cnl::quotient(m_p + m_d, m_kp)), m_interval);
         m_integral += integral_increase;
         m_i = m_integral * safe_elastic_fixed_point<4, 27>(cnl::quotient(m_kp, m_ti));
     } else {
@@ -111,7 +131,7 @@ Pid::update()
                         }
 
                         out_t excess = cnl::quotient(pidResult - antiWindupValue, m_kp);
-                        antiWindup += int8_t(3) * excess; // anti windup gain is 3
+                        antiWindup += scaleToInterval(integral_t(int8_t(3) * excess), m_interval); // anti windup gain is 3
                     }
                     // make sure integral does not cross zero and does not increase by anti-windup
                     integral_t newIntegral = m_integral - antiWindup;
@@ -168,18 +188,21 @@ Pid::checkFilterLength()
 {
 
     // delay for each filter between input step and max derivative: 8, 34, 85, 188, 492, 1428
+    // limits are in filter samples, Td is in seconds
     const uint16_t limits[6] = {20, 89, 179, 359, 959, 1799};
-    if (!m_derivativeFilterNr) {
-        if (auto input = m_inputPtr()) {
+    if (auto input = m_inputPtr()) {
+        auto filterInterval = input->filterInterval();
+        if (!m_derivativeFilterNr || filterInterval != m_derivativeFilterInterval) {
             // selected filter must use an update interval a lot faster than Td to be meaningful
             // The filter delay is roughly 6x the update rate.
             m_derivativeFilterNr = 1;
             while (m_derivativeFilterNr < 6) {
-                if (limits[m_derivativeFilterNr - 1] >= m_td) {
+                if (uint32_t(limits[m_derivativeFilterNr - 1]) * filterInterval >= uint32_t(m_td) * 1000) {
                     break;
                 }
                 ++m_derivativeFilterNr;
             };
+            m_derivativeFilterInterval = filterInterval;
             input->resizeFilterIfNeeded(m_derivativeFilterNr);
         }
     }
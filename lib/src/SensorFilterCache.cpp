@@ -0,0 +1,111 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../inc/SensorFilterCache.h"
+#include <algorithm>
+
+void
+SensorFilterCache::Entry::configure(const Settings& settings)
+{
+    if (settings.stepThreshold != m_settings.stepThreshold) {
+        m_filter.setStepThreshold(cnl::wrap<temp_t>(settings.stepThreshold));
+    }
+    m_filter.sampleInterval(settings.sampleInterval);
+    m_settings = settings;
+}
+
+void
+SensorFilterCache::Entry::update(uint32_t& consumerSamples, const std::shared_ptr<TempSensor>& sensor)
+{
+    if (consumerSamples != m_samples) {
+        // another consumer added the sample for this interval
+        consumerSamples = m_samples;
+        return;
+    }
+    if (sensor && sensor->valid()) {
+        auto val = sensor->value();
+        if (!valueValid()) {
+            m_filter.reset(val);
+        }
+        m_filter.add(val);
+        m_sensorFailureCount = 0;
+    } else {
+        if (m_sensorFailureCount < 255) {
+            m_sensorFailureCount++;
+        }
+    }
+    consumerSamples = ++m_samples;
+}
+
+void
+SensorFilterCache::Entry::reset(const temp_t& value)
+{
+    m_filter.reset(value);
+    m_sensorFailureCount = 0;
+}
+
+std::shared_ptr<SensorFilterCache::Entry>
+SensorFilterCache::find(const std::shared_ptr<TempSensor>& sensor, const Settings& settings)
+{
+    for (auto& e : entries) {
+        if (auto entry = e.lock()) {
+            if (entry->sensorIs(sensor) && entry->settings() == settings) {
+                return entry;
+            }
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<SensorFilterCache::Entry>
+SensorFilterCache::acquire(const std::shared_ptr<TempSensor>& sensor, const Settings& settings)
+{
+    if (auto entry = find(sensor, settings)) {
+        return entry;
+    }
+    return create(sensor, settings);
+}
+
+std::shared_ptr<SensorFilterCache::Entry>
+SensorFilterCache::create(const std::shared_ptr<TempSensor>& sensor, const Settings& settings)
+{
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const std::weak_ptr<Entry>& e) {
+                      return e.expired();
+                  }),
+                  entries.end());
+
+    auto entry = std::make_shared<Entry>(sensor, settings);
+    entries.push_back(entry);
+    return entry;
+}
+
+size_t
+SensorFilterCache::size() const
+{
+    return std::count_if(entries.begin(), entries.end(), [](const std::weak_ptr<Entry>& e) {
+        return !e.expired();
+    });
+}
+
+SensorFilterCache&
+sensorFilterCache()
+{
+    static SensorFilterCache cache;
+    return cache;
+}
@@ -19,14 +19,115 @@
 
 #include "../inc/SetpointProfile.h"
 
+namespace {
 void
-SetpointProfile::update(const utc_seconds_t& time)
+putVarint(std::vector<uint8_t>& out, uint32_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(uint8_t(v));
+}
+
+bool
+getVarint(const uint8_t*& pos, const uint8_t* end, uint32_t& v)
+{
+    v = 0;
+    for (uint8_t shift = 0; pos != end && shift < 35; shift += 7) {
+        uint8_t b = *pos++;
+        v |= uint32_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// differences are calculated modulo 2^32, so any value can be restored exactly
+uint32_t
+zigzag(uint32_t delta)
+{
+    return (delta << 1) ^ uint32_t(int32_t(delta) >> 31);
+}
+
+uint32_t
+unzigzag(uint32_t v)
 {
-    struct TimeStampLessEqual {
-        bool operator()(const Point& p, const utc_seconds_t& time) const { return p.time <= time; }
-        bool operator()(const utc_seconds_t& time, const Point& p) const { return time <= p.time; }
-    };
+    return (v >> 1) ^ (0 - (v & 1));
+}
+} // end anonymous namespace
 
+bool
+ProfilePoints::Reader::next(Point& p)
+{
+    uint32_t dt;
+    uint32_t dtemp;
+    if (!getVarint(pos, end, dt) || !getVarint(pos, end, dtemp)) {
+        return false;
+    }
+    last.time += unzigzag(dt);
+    last.temp = cnl::wrap<temp_t>(int32_t(uint32_t(cnl::unwrap(last.temp)) + unzigzag(dtemp)));
+    p = last;
+    return true;
+}
+
+void
+ProfilePoints::push_back(const Point& p)
+{
+    putVarint(m_data, zigzag(p.time - m_last.time));
+    putVarint(m_data, zigzag(uint32_t(cnl::unwrap(p.temp)) - uint32_t(cnl::unwrap(m_last.temp))));
+    m_last = p;
+    ++m_size;
+}
+
+size_t
+ProfilePoints::read(size_t first, Point* dest, size_t maxCount) const
+{
+    auto r = reader();
+    Point p;
+    for (size_t i = 0; i < first; ++i) {
+        if (!r.next(p)) {
+            return 0;
+        }
+    }
+    size_t count = 0;
+    while (count < maxCount && r.next(p)) {
+        dest[count++] = p;
+    }
+    return count;
+}
+
+void
+ProfilePoints::write(size_t first, const Point* src, size_t count)
+{
+    auto r = reader();
+    Point p{0, temp_t(0)};
+    Point last{0, temp_t(0)};
+    uint16_t kept = 0;
+    while (kept < first && r.next(p)) {
+        last = p;
+        ++kept;
+    }
+    m_data.resize(r.position() - m_data.data());
+    m_last = last;
+    m_size = kept;
+    for (size_t i = 0; i < count; ++i) {
+        push_back(src[i]);
+    }
+}
+
+void
+SetpointProfile::resetCursor()
+{
+    m_cursor.reader = m_points.reader();
+    m_cursor.hasLower = false;
+    m_cursor.hasUpper = m_cursor.reader.next(m_cursor.upper);
+}
+
+void
+SetpointProfile::update(const utc_seconds_t& time)
+{
     if (!isDriving()) {
         return;
     }
@@ -39,15 +140,25 @@ SetpointProfile::update(const utc_seconds_t& time)
             return;
         }
         auto elapsed = time - m_profileStartTime;
-        auto upper = std::lower_bound(m_points.cbegin(), m_points.cend(), elapsed, TimeStampLessEqual{});
-        if (upper == m_points.cend()) { // every point is in the past, use the last point
-            newTemp = m_points.back().temp;
-        } else if (upper != m_points.cbegin()) { // first point is not in the future
-            auto lower = upper - 1;
-            auto segmentElapsed = elapsed - lower->time;
-            auto segmentDuration = upper->time - lower->time;
+        if (m_cursor.hasLower && elapsed < m_cursor.lower.time) {
+            resetCursor(); // time went back, start over
+        }
+        // advance until upper is the first point after elapsed
+        while (m_cursor.hasUpper && m_cursor.upper.time <= elapsed) {
+            m_cursor.lower = m_cursor.upper;
+            m_cursor.hasLower = true;
+            m_cursor.hasUpper = m_cursor.reader.next(m_cursor.upper);
+        }
+
+        if (!m_cursor.hasUpper) { // every point is in the past, use the last point
+            newTemp = m_cursor.lower.temp;
+        } else if (m_cursor.hasLower) { // first point is not in the future
+            auto& lower = m_cursor.lower;
+            auto& upper = m_cursor.upper;
+            auto segmentElapsed = elapsed - lower.time;
+            auto segmentDuration = upper.time - lower.time;
             auto fraction = safe_elastic_fixed_point<1, 30>(cnl::quotient(segmentElapsed, segmentDuration));
-            auto interpolated = lower->temp + temp_t((upper->temp - lower->temp) * fraction);
+            auto interpolated = lower.temp + temp_t((upper.temp - lower.temp) * fraction);
             newTemp = interpolated;
         } else {
             return;
@@ -57,4 +168,4 @@ SetpointProfile::update(const utc_seconds_t& time)
             targetPtr->settingValid(true);
         }
     }
-}
\ No newline at end of file
+}
@@ -173,3 +173,129 @@ SCENARIO("ActuatorDigitalChangeLogged test", "[ActuatorChangeLog]")
         }
     }
 }
+
+SCENARIO("ActuatorDigitalChangeLogged keeps the durations of completed states between transitions", "[ActuatorChangeLog]")
+{
+    using State = ActuatorDigitalBase::State;
+
+    auto mockIo = std::make_shared<MockIoArray>();
+    ActuatorDigital mock([mockIo]() { return mockIo; }, 1);
+    ActuatorDigitalChangeLogged logged(mock);
+
+    auto toggle = [&logged](const ticks_millis_t& start) {
+        // active for 300ms, then inactive for 700ms
+        logged.state(State::Active, start);
+        logged.state(State::Inactive, start + 300);
+    };
+
+    WHEN("The state changes, the durations read before and after the change continue from the same history")
+    {
+        toggle(1000);
+        toggle(2000);
+        logged.state(State::Active, 3000);
+
+        auto before = logged.activeDurations(3200);
+        CHECK(before.currentActive == 200);
+        CHECK(before.currentPeriod == 900);
+        CHECK(before.previousActive == 300);
+        CHECK(before.previousPeriod == 1000);
+
+        logged.state(State::Inactive, 3200);
+        auto after = logged.activeDurations(3200);
+        CHECK(after.currentActive == before.currentActive);
+        CHECK(after.currentPeriod == before.currentActive);
+        CHECK(after.previousActive == before.previousActive);
+        CHECK(after.previousPeriod == before.previousPeriod);
+
+        THEN("Only the duration of the current state increases with time")
+        {
+            auto later = logged.activeDurations(3700);
+            CHECK(later.currentActive == 200);
+            CHECK(later.currentPeriod == 700);
+            CHECK(later.previousActive == 300);
+            CHECK(later.previousPeriod == 1000);
+        }
+    }
+
+    WHEN("The history is reset")
+    {
+        toggle(1000);
+        toggle(2000);
+        logged.resetHistory();
+
+        THEN("The durations only include the time since the reset")
+        {
+            // the Unknown entries of the reset history start 1ms before tick 0
+            auto durations = logged.activeDurations(500);
+            CHECK(durations.currentActive == 0);
+            CHECK(durations.currentPeriod == 501);
+            CHECK(durations.previousActive == 0);
+            CHECK(durations.previousPeriod == 0);
+            CHECK(durations.lastState == State::Inactive);
+        }
+
+        AND_WHEN("The state changes after the reset")
+        {
+            toggle(1000);
+            auto durations = logged.activeDurations(1500);
+            CHECK(durations.currentActive == 300);
+            CHECK(durations.currentPeriod == 500);
+            CHECK(durations.previousActive == 0);
+            CHECK(durations.previousPeriod == 1001);
+        }
+    }
+
+    WHEN("The ticks wrap around between state changes")
+    {
+        auto mockIo2 = std::make_shared<MockIoArray>();
+        ActuatorDigital mock2([mockIo2]() { return mockIo2; }, 1);
+        ActuatorDigitalChangeLogged reference(mock2);
+
+        ticks_millis_t offset = ticks_millis_t(-2500);
+        for (ticks_millis_t t = 0; t < 5000; t += 1000) {
+            toggle(t + offset);
+            reference.state(State::Active, t);
+            reference.state(State::Inactive, t + 300);
+        }
+
+        THEN("The durations are the same as without wraparound")
+        {
+            for (ticks_millis_t t = 4300; t < 6000; t += 100) {
+                auto durations = logged.activeDurations(t + offset);
+                auto expected = reference.activeDurations(t);
+                CHECK(durations.currentActive == expected.currentActive);
+                CHECK(durations.currentPeriod == expected.currentPeriod);
+                CHECK(durations.previousActive == expected.previousActive);
+                CHECK(durations.previousPeriod == expected.previousPeriod);
+            }
+            auto expected = reference.activeDurations(5000);
+            CHECK(expected.currentActive == 300);
+            CHECK(expected.currentPeriod == 1000);
+        }
+    }
+
+    WHEN("A longer history is configured")
+    {
+        ActuatorDigitalChangeLogged longLogged(mock, 9);
+        CHECK(longLogged.historyLength() == 9);
+        CHECK(logged.historyLength() == 5);
+
+        for (ticks_millis_t t = 1000; t < 6000; t += 1000) {
+            longLogged.state(State::Active, t);
+            longLogged.state(State::Inactive, t + 300);
+        }
+
+        THEN("The durations of the current and previous period are the same as with the default length")
+        {
+            auto durations = longLogged.activeDurations(6000);
+            CHECK(durations.currentActive == 300);
+            CHECK(durations.currentPeriod == 1000);
+            CHECK(durations.previousActive == 300);
+            CHECK(durations.previousPeriod == 1000);
+
+            auto times = longLogged.getLastStartEndTime(State::Active, 6000);
+            CHECK(times.start == 5000);
+            CHECK(times.end == 5300);
+        }
+    }
+}
@@ -25,6 +25,43 @@
 
 using State = ActuatorDigital::State;
 
+namespace {
+// wraps a constraint and counts how often it is asked whether a state is allowed
+class CountingConstraint : public ADConstraints::Base {
+private:
+    std::unique_ptr<ADConstraints::Base> m_wrapped;
+
+public:
+    uint32_t calls = 0;
+
+    CountingConstraint(std::unique_ptr<ADConstraints::Base>&& wrapped)
+        : m_wrapped(std::move(wrapped))
+    {
+    }
+
+    virtual duration_millis_t allowedImpl(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act) override final
+    {
+        ++calls;
+        return m_wrapped->allowed(newState, now, act);
+    }
+
+    virtual duration_millis_t nextDecision() const override final
+    {
+        return m_wrapped->nextDecision();
+    }
+
+    virtual uint8_t id() const override final
+    {
+        return m_wrapped->id();
+    }
+
+    virtual uint8_t order() const override final
+    {
+        return m_wrapped->order();
+    }
+};
+}
+
 SCENARIO("ActuatorDigitalConstrained", "[constraints]")
 {
     auto now = ticks_millis_t(0);
@@ -130,6 +167,57 @@ SCENARIO("ActuatorDigitalConstrained", "[constraints]")
     }
 }
 
+SCENARIO("ActuatorDigitalConstrained only asks a blocking constraint again when its decision can change", "[constraints]")
+{
+    auto now = ticks_millis_t(0);
+
+    auto mockIo = std::make_shared<MockIoArray>();
+    ActuatorDigital mock([mockIo]() { return mockIo; }, 1);
+    ActuatorDigitalConstrained constrained(mock);
+
+    constrained.desiredState(State::Inactive, now);
+    auto counting = std::make_unique<CountingConstraint>(std::make_unique<ADConstraints::MinOffTime<1>>(10000));
+    auto& calls = counting->calls;
+    constrained.addConstraint(std::move(counting));
+
+    WHEN("A PWM actuator requests the blocked state every millisecond")
+    {
+        duration_millis_t remaining = 0;
+        while (constrained.state() == State::Inactive) {
+            remaining = constrained.desiredState(State::Active, ++now);
+        }
+
+        THEN("The state changes at the same time, but the constraint is asked once per second instead of every millisecond")
+        {
+            auto timesOff = constrained.getLastStartEndTime(State::Inactive, now);
+            CHECK(timesOff.end - timesOff.start == 10000);
+            CHECK(remaining == 0);
+            CHECK(calls == 11);
+        }
+    }
+
+    WHEN("The actuator is blocked")
+    {
+        CHECK(constrained.desiredState(State::Active, now) == 10000);
+        CHECK(calls == 1);
+
+        THEN("The returned and published time remaining still count down")
+        {
+            CHECK(constrained.desiredState(State::Active, now + 300) == 9700);
+            CHECK(constrained.constraintsList().front()->timeRemaining() == 9700);
+            CHECK(calls == 1);
+        }
+
+        THEN("Requesting another state asks the constraint again")
+        {
+            constrained.desiredState(State::Inactive, now + 300);
+            CHECK(calls == 2);
+            CHECK(constrained.desiredState(State::Active, now + 400) == 9600);
+            CHECK(calls == 3);
+        }
+    }
+}
+
 SCENARIO("Mutex contraint", "[constraints]")
 {
     auto now = ticks_millis_t(0);
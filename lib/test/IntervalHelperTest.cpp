@@ -26,17 +26,17 @@ SCENARIO("IntervalHelper test")
 {
     WHEN("The interval helper is irregularly updated, it will still give the correct number of updates")
     {
-        auto testInterval = [](int maxDelay) {
-            IntervalHelper<1000> ivh;
+        auto testInterval = [](int maxDelay, duration_millis_t interval) {
+            IntervalHelper ivh(interval);
 
             ticks_millis_t now = 0;
             int numUpdates = 0;
             ticks_millis_t nextUpdate = 0;
-            while (now < 1000'000) {
+            while (now < 1000 * interval) {
                 bool doUpdate = false;
 
                 nextUpdate = ivh.update(now, doUpdate);
-                CHECK(nextUpdate <= now + 1000);
+                CHECK(nextUpdate <= now + interval);
                 if (doUpdate) {
                     numUpdates++;
                 }
@@ -49,9 +49,50 @@ SCENARIO("IntervalHelper test")
             CHECK(numUpdates == 1000);
         };
 
-        testInterval(100);
-        testInterval(1000);
-        testInterval(1500);
-        testInterval(3000);
+        testInterval(100, 1000);
+        testInterval(1000, 1000);
+        testInterval(1500, 1000);
+        testInterval(3000, 1000);
+    }
+
+    WHEN("The interval is shorter than a second, the number of updates is scaled accordingly")
+    {
+        auto testInterval = [](int maxDelay, duration_millis_t interval) {
+            IntervalHelper ivh(interval);
+
+            ticks_millis_t now = 0;
+            int numUpdates = 0;
+            while (now < 100'000) {
+                bool doUpdate = false;
+                auto nextUpdate = ivh.update(now, doUpdate);
+                CHECK(nextUpdate <= now + interval);
+                if (doUpdate) {
+                    numUpdates++;
+                }
+                now = now + 1 + std::rand() % maxDelay;
+            }
+            CHECK(numUpdates == 100'000 / interval);
+        };
+
+        testInterval(10, 100);
+        testInterval(150, 100);
+        testInterval(50, 250);
+    }
+
+    WHEN("The interval is changed at runtime, the new interval is used from the next update")
+    {
+        IntervalHelper ivh;
+        bool doUpdate = false;
+        CHECK(ivh.interval() == 1000);
+        CHECK(ivh.update(0, doUpdate) == 1000);
+        CHECK(doUpdate);
+
+        ivh.interval(100);
+        CHECK(ivh.interval() == 100);
+        doUpdate = false;
+        CHECK(ivh.update(50, doUpdate) == 100);
+        CHECK(!doUpdate);
+        CHECK(ivh.update(100, doUpdate) == 200);
+        CHECK(doUpdate);
     }
 }
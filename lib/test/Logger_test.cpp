@@ -0,0 +1,107 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewBlox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "Logger.h"
+#include "TestLogger.h"
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<std::string> logged;
+uint32_t testMillis = 0;
+
+void
+writeTestLog(Logger::LogLevel, const char* message, size_t length)
+{
+    logged.emplace_back(message, length);
+}
+
+uint32_t
+testClock()
+{
+    return testMillis;
+}
+}
+
+SCENARIO("Log messages are formatted without allocating", "[logger]")
+{
+    logged.clear();
+    testMillis = 0;
+    Logger testLogger(writeTestLog, testClock);
+
+    WHEN("Strings, numbers and hex bytes are logged")
+    {
+        testLogger(Logger::INFO, "text ") << uint32_t(123) << " " << int32_t(-45) << " ";
+        testLogger(Logger::INFO, "").appendHex(0x0A).appendHex(0xF1);
+
+        THEN("They are formatted in the message")
+        {
+            REQUIRE(logged.size() == 2);
+            CHECK(logged[0] == "text 123 -45 ");
+            CHECK(logged[1] == "0AF1");
+        }
+    }
+
+    WHEN("A message is longer than the maximum length")
+    {
+        testLogger(Logger::INFO, std::string(Logger::maxLength() + 10, 'x').c_str());
+
+        THEN("It is truncated")
+        {
+            REQUIRE(logged.size() == 1);
+            CHECK(logged[0] == std::string(Logger::maxLength(), 'x'));
+        }
+    }
+
+    WHEN("A call site logs more messages than its rate limit allows")
+    {
+        Logger::RateLimit limit;
+        for (int i = 0; i < 20; i++) {
+            testLogger(Logger::WARN, limit, "flood");
+        }
+
+        THEN("The messages over the limit are suppressed")
+        {
+            CHECK(logged.size() == Logger::burst());
+        }
+
+        THEN("Another call site is not affected")
+        {
+            Logger::RateLimit otherLimit;
+            testLogger(Logger::WARN, otherLimit, "other");
+            CHECK(logged.back() == "other");
+        }
+
+        THEN("The number of suppressed messages is logged when the window has passed")
+        {
+            testMillis += Logger::window();
+            testLogger(Logger::WARN, limit, "flood");
+            CHECK(logged.back() == "flood (15 suppressed)");
+        }
+    }
+}
+
+SCENARIO("The CL_LOG macros write to the application logger", "[logger]")
+{
+    TestLogger::clear();
+    CL_LOG_INFO("number ") << uint32_t(10);
+    CHECK(TestLogger::count("LOG(INFO): number 10") == 1);
+}
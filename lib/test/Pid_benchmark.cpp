@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewBlox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Closed loop pid benchmark. It is hidden from the normal test run, run it with:
+ * make benchmark
+ * or
+ * ./build/lib_test_runner "[benchmark]"
+ */
+
+#include <catch.hpp>
+
+#include "ActuatorAnalogMock.h"
+#include "Pid.h"
+#include "SetpointSensorPair.h"
+#include "TempSensorMock.h"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+// Runs a kettle model for an hour of simulated time and measures the time spent in the pair and pid updates.
+void
+runClosedLoop(duration_millis_t interval)
+{
+    auto sensor = std::make_shared<TempSensorMock>(20.0);
+    auto input = std::make_shared<SetpointSensorPair>([&sensor]() { return sensor; });
+    input->settingValid(true);
+    input->setting(60);
+    input->filterChoice(1);
+    input->sampleInterval(interval);
+
+    auto actuator = std::make_shared<ActuatorAnalogMock>(0, 0, 100);
+
+    Pid pid(
+        [&input]() { return input; },
+        [&actuator]() { return actuator; });
+    pid.updateInterval(interval);
+    pid.enabled(true);
+    pid.kp(100);
+    pid.td(120);
+    pid.ti(1200);
+
+    double temp = 20;
+    double totalUs = 0;
+    double worstUs = 0;
+    uint32_t updates = 0;
+    duration_millis_t reached = 0;
+    for (duration_millis_t now = 0; now < 3600'000; now += interval) {
+        temp += double(actuator->value()) / 2400 * interval / 1000;
+        sensor->setting(temp_t(temp));
+
+        auto start = std::chrono::steady_clock::now();
+        input->update();
+        pid.update();
+        auto end = std::chrono::steady_clock::now();
+
+        auto us = std::chrono::duration<double, std::micro>(end - start).count();
+        totalUs += us;
+        worstUs = std::max(worstUs, us);
+        ++updates;
+        if (!reached && temp + 0.1 >= 60) {
+            reached = now;
+        }
+    }
+
+    printf("interval %5u ms | %7u updates | avg %6.2f us  worst %7.2f us | %8.1f us per simulated second | setpoint reached at %5.1f min\n",
+           interval, updates, totalUs / updates, worstUs, totalUs / 3600, reached / 60000.0);
+    CHECK(reached > 0);
+}
+
+} // end anonymous namespace
+
+TEST_CASE("Closed loop pid benchmark at different update intervals", "[.][benchmark]")
+{
+    runClosedLoop(1000);
+    runClosedLoop(500);
+    runClosedLoop(200);
+    runClosedLoop(100);
+    runClosedLoop(50);
+}
@@ -67,6 +67,18 @@ SCENARIO("PID Test with mock actuator", "[pid]")
             CHECK(pid.derivativeFilterNr() == 1);
         }
 
+        THEN("The published state matches the state of the pid")
+        {
+            auto state = pid.state();
+            CHECK(state.p == pid.p());
+            CHECK(state.i == pid.i());
+            CHECK(state.d == pid.d());
+            CHECK(state.error == pid.error());
+            CHECK(state.integral == pid.integral());
+            CHECK(state.active == pid.active());
+            CHECK(state.active);
+        }
+
         CHECK(actuator->setting() == Approx(10).margin(0.01));
     }
 
@@ -1095,4 +1107,96 @@ SCENARIO("PID Test with PWM actuator", "[pid]")
             CHECK(pid.i() < 1.0);
         }
     }
-}
\ No newline at end of file
+}
+
+SCENARIO("PID with a configurable update interval", "[pid]")
+{
+    // heats a kettle from 20 to 60 degrees with a simple model, updating the pair and pid at the given interval
+    struct KettleResult {
+        duration_millis_t reached;
+        double overshoot;
+    };
+
+    auto runKettle = [](duration_millis_t interval) {
+        auto sensor = std::make_shared<TempSensorMock>(20.0);
+        auto input = std::make_shared<SetpointSensorPair>([&sensor]() { return sensor; });
+        input->settingValid(true);
+        input->setting(60);
+        input->filterChoice(1); // filters over the same time at each interval
+        input->sampleInterval(interval);
+
+        auto actuator = std::make_shared<ActuatorAnalogMock>(0, 0, 100);
+
+        Pid pid(
+            [&input]() { return input; },
+            [&actuator]() { return actuator; });
+        pid.updateInterval(interval);
+        pid.enabled(true);
+        pid.kp(100);
+        pid.td(120);
+        pid.ti(1200);
+
+        double temp = 20;
+        KettleResult result{0, 0};
+        for (duration_millis_t now = 0; now < 3600'000; now += interval) {
+            temp += double(actuator->value()) / 2400 * interval / 1000;
+            sensor->setting(temp_t(temp));
+            input->update();
+            pid.update();
+            if (!result.reached && temp + 0.1 >= 60) {
+                result.reached = now;
+            }
+            result.overshoot = std::max(result.overshoot, temp - 60);
+        }
+        return result;
+    };
+
+    auto reference = runKettle(1000);
+
+    WHEN("The interval is one second")
+    {
+        THEN("The setpoint is reached within half an hour with little overshoot")
+        {
+            CHECK(reference.reached > 0);
+            CHECK(reference.reached < 1800'000);
+            CHECK(reference.overshoot < 0.5);
+        }
+    }
+
+    WHEN("The pid and pair run faster than once per second, the response matches the response at one second")
+    {
+        // the integral and derivative are scaled to the interval
+        for (duration_millis_t interval : {500, 200, 100}) {
+            auto result = runKettle(interval);
+            INFO("interval " << interval);
+            CHECK(result.reached == Approx(reference.reached).epsilon(0.1));
+            CHECK(result.overshoot < 0.5);
+        }
+    }
+
+    WHEN("The pair runs at a different interval, the derivative filter is selected for the same delay in seconds")
+    {
+        auto sensor = std::make_shared<TempSensorMock>(20.0);
+        auto input = std::make_shared<SetpointSensorPair>([&sensor]() { return sensor; });
+        input->settingValid(true);
+        auto actuator = std::make_shared<ActuatorAnalogMock>();
+        Pid pid(
+            [&input]() { return input; },
+            [&actuator]() { return actuator; });
+        pid.enabled(true);
+        pid.kp(10);
+        pid.td(60);
+        CHECK(pid.derivativeFilterNr() == 2);
+
+        // samples faster than a second are averaged, so the filter delay in seconds is unchanged
+        input->sampleInterval(100);
+        input->update();
+        pid.update();
+        CHECK(pid.derivativeFilterNr() == 2);
+
+        input->sampleInterval(3000);
+        input->update();
+        pid.update();
+        CHECK(pid.derivativeFilterNr() == 1);
+    }
+}
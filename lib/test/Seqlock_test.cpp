@@ -0,0 +1,92 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewBlox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "Seqlock.h"
+#include <thread>
+
+namespace {
+struct Triple {
+    int32_t a;
+    int32_t b;
+    int16_t sum;
+    bool valid;
+};
+}
+
+SCENARIO("A seqlock holds a consistent snapshot of a value", "[seqlock]")
+{
+    Seqlock<Triple> snapshot;
+
+    WHEN("Nothing is published yet")
+    {
+        THEN("A value-initialized value is read")
+        {
+            auto value = snapshot.read();
+            CHECK(value.a == 0);
+            CHECK(value.b == 0);
+            CHECK(value.sum == 0);
+            CHECK(value.valid == false);
+            CHECK(snapshot.version() == 0);
+        }
+    }
+
+    WHEN("A value is published")
+    {
+        snapshot.publish(Triple{1, 2, 3, true});
+
+        THEN("It is read back and the version is incremented")
+        {
+            auto value = snapshot.read();
+            CHECK(value.a == 1);
+            CHECK(value.b == 2);
+            CHECK(value.sum == 3);
+            CHECK(value.valid == true);
+            CHECK(snapshot.version() == 1);
+        }
+    }
+
+    WHEN("A writer thread publishes while another thread reads")
+    {
+        std::thread writer([&snapshot]() {
+            for (int32_t i = 1; i <= 100000; i++) {
+                snapshot.publish(Triple{i, -i, int16_t(i - i), true});
+            }
+        });
+
+        bool consistent = true;
+        int32_t last = 0;
+        while (last < 100000) {
+            auto value = snapshot.read();
+            if (value.a != -value.b || value.sum != 0 || value.a < last) {
+                consistent = false;
+                break;
+            }
+            last = value.a;
+        }
+        writer.join();
+
+        THEN("All values that are read are consistent and never older than a previous read")
+        {
+            CHECK(consistent);
+            CHECK(snapshot.version() == 100000);
+        }
+    }
+}
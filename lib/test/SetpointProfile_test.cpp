@@ -226,3 +226,94 @@ SCENARIO("SetpointProfile test", "[SetpointProfile]")
         CHECK(profile.isDriving() == true);
     }
 }
+
+SCENARIO("SetpointProfile points are stored delta encoded and can be read and written in pages", "[SetpointProfile]")
+{
+    ProfilePoints points;
+
+    WHEN("Points are added")
+    {
+        points.push_back(ProfilePoints::Point{utc_seconds_t(0), temp_t(20)});
+        points.push_back(ProfilePoints::Point{utc_seconds_t(86400), temp_t(20)});
+        points.push_back(ProfilePoints::Point{utc_seconds_t(90000), temp_t(-2.5)});
+        points.push_back(ProfilePoints::Point{utc_seconds_t(3600), temp_t(10)}); // out of order
+
+        THEN("They are read back exactly")
+        {
+            ProfilePoints::Point read[5];
+            REQUIRE(points.read(0, read, 5) == 4);
+            CHECK(points.size() == 4);
+            CHECK(read[0].time == 0);
+            CHECK(read[0].temp == temp_t(20));
+            CHECK(read[1].time == 86400);
+            CHECK(read[1].temp == temp_t(20));
+            CHECK(read[2].time == 90000);
+            CHECK(read[2].temp == temp_t(-2.5));
+            CHECK(read[3].time == 3600);
+            CHECK(read[3].temp == temp_t(10));
+        }
+
+        THEN("They use less memory than the absolute values")
+        {
+            CHECK(points.encodedSize() < 4 * sizeof(ProfilePoints::Point));
+        }
+
+        THEN("A page of points can be read")
+        {
+            ProfilePoints::Point read[2];
+            REQUIRE(points.read(1, read, 2) == 2);
+            CHECK(read[0].time == 86400);
+            CHECK(read[1].time == 90000);
+            CHECK(points.read(4, read, 2) == 0);
+        }
+
+        THEN("The points from a page onwards can be rewritten")
+        {
+            ProfilePoints::Point page[] = {{utc_seconds_t(7200), temp_t(21)}, {utc_seconds_t(10800), temp_t(22)}};
+            points.write(1, page, 2);
+            ProfilePoints::Point read[5];
+            REQUIRE(points.read(0, read, 5) == 3);
+            CHECK(read[0].time == 0);
+            CHECK(read[0].temp == temp_t(20));
+            CHECK(read[1].time == 7200);
+            CHECK(read[1].temp == temp_t(21));
+            CHECK(read[2].time == 10800);
+            CHECK(read[2].temp == temp_t(22));
+        }
+    }
+}
+
+SCENARIO("SetpointProfile continues from the current segment on each update", "[SetpointProfile]")
+{
+    auto sensor = std::make_shared<TempSensorMock>(20.0);
+    auto sspair = std::make_shared<SetpointSensorPair>([sensor]() { return sensor; });
+    SetpointProfile profile([&sspair]() { return sspair; });
+
+    SetpointProfile::Point points[] = {
+        {utc_seconds_t(0), temp_t(10)},
+        {utc_seconds_t(10), temp_t(20)},
+        {utc_seconds_t(20), temp_t(20)},
+        {utc_seconds_t(30), temp_t(40)},
+    };
+    profile.startTime(100);
+    profile.writePoints(0, points, 4);
+
+    WHEN("Time moves forward")
+    {
+        profile.update(105);
+        CHECK(sspair->setting() == Approx(15).margin(0.001));
+        profile.update(115);
+        CHECK(sspair->setting() == Approx(20).margin(0.001));
+        profile.update(125);
+        CHECK(sspair->setting() == Approx(30).margin(0.001));
+
+        AND_WHEN("Time moves back")
+        {
+            profile.update(102);
+            THEN("The setpoint is interpolated from the start of the profile again")
+            {
+                CHECK(sspair->setting() == Approx(12).margin(0.001));
+            }
+        }
+    }
+}
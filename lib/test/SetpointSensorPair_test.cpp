@@ -36,3 +36,181 @@ SCENARIO("SetpointSensorPair test")
         CHECK(pair.value() == 21.0);
     }
 }
+
+SCENARIO("SetpointSensorPairs that use the same sensor share the filtered value")
+{
+    auto sensor = std::make_shared<TempSensorMock>(21.0);
+    auto entriesBefore = sensorFilterCache().size();
+
+    auto pair1 = std::make_unique<SetpointSensorPair>([sensor]() { return sensor; });
+    auto pair2 = std::make_unique<SetpointSensorPair>([sensor]() { return sensor; });
+
+    WHEN("Both pairs have the same filter settings")
+    {
+        THEN("They use a single cache entry")
+        {
+            CHECK(sensorFilterCache().size() == entriesBefore + 1);
+        }
+
+        AND_WHEN("Both pairs are updated each interval")
+        {
+            pair1->filterChoice(1);
+            pair2->filterChoice(0); // unfiltered
+            for (int i = 0; i < 100; i++) {
+                sensor->setting(21 + i / 10);
+                pair1->update();
+                pair2->update();
+            }
+
+            THEN("Each sample is only added to the filter once, but each pair reads its own filter stage")
+            {
+                // a pair for another sensor with the same values, that is updated once per interval
+                auto sensor2 = std::make_shared<TempSensorMock>(21.0);
+                SetpointSensorPair single([sensor2]() { return sensor2; });
+                for (int i = 0; i < 100; i++) {
+                    sensor2->setting(21 + i / 10);
+                    single.update();
+                }
+                CHECK(pair1->value() == single.value());
+                CHECK(pair2->value() == temp_t(30));
+            }
+        }
+
+        AND_WHEN("One pair is destroyed")
+        {
+            for (int i = 0; i < 10; i++) {
+                pair1->update();
+                pair2->update();
+            }
+            pair1.reset();
+            pair2->update();
+
+            THEN("The other pair keeps the entry and its history")
+            {
+                CHECK(sensorFilterCache().size() == entriesBefore + 1);
+                CHECK(pair2->valueValid());
+                CHECK(pair2->value() == temp_t(21));
+            }
+        }
+
+        AND_WHEN("One pair resets its filter")
+        {
+            for (int i = 0; i < 10; i++) {
+                sensor->setting(21 + i);
+                pair1->update();
+                pair2->update();
+            }
+            auto historyBefore = pair2->value();
+            sensor->setting(40);
+            pair1->resetFilter();
+
+            THEN("It continues with a separate entry and the other pair keeps its history")
+            {
+                CHECK(sensorFilterCache().size() == entriesBefore + 2);
+                CHECK(pair1->value() == temp_t(40));
+                CHECK(pair2->value() == historyBefore);
+                CHECK(pair2->value() < temp_t(30));
+            }
+        }
+
+        AND_WHEN("Both pairs are destroyed, the entry is freed")
+        {
+            pair1.reset();
+            pair2.reset();
+            CHECK(sensorFilterCache().size() == entriesBefore);
+        }
+    }
+
+    WHEN("One of the pairs uses a different step threshold")
+    {
+        pair2->filterThreshold(2);
+
+        THEN("It uses a separate cache entry")
+        {
+            CHECK(sensorFilterCache().size() == entriesBefore + 2);
+            CHECK(pair2->valueValid());
+            CHECK(pair2->value() == temp_t(21));
+        }
+
+        AND_WHEN("The other pair is set to the same threshold, they share an entry again")
+        {
+            pair1->filterThreshold(2);
+            CHECK(sensorFilterCache().size() == entriesBefore + 1);
+        }
+    }
+}
+
+SCENARIO("The filter choice of a SetpointSensorPair is a delay in seconds, independent of the sample interval")
+{
+    auto sensor = std::make_shared<TempSensorMock>(20.0);
+    SetpointSensorPair slow([sensor]() { return sensor; });
+    SetpointSensorPair fast([sensor]() { return sensor; });
+    slow.filterChoice(1);
+    fast.filterChoice(1);
+    fast.sampleInterval(100);
+    // start the filters at the value before the step
+    slow.update();
+    fast.update();
+
+    THEN("The pair that samples faster averages its samples and reads the same filter stage")
+    {
+        CHECK(fast.filterChoice() == 1);
+        CHECK(fast.filterInterval() == 1000);
+        CHECK(slow.filterLength() == 1);
+        CHECK(fast.filterLength() == 1);
+    }
+
+    WHEN("The sensor value steps from 20 to 30")
+    {
+        sensor->setting(30);
+        auto run = [&](duration_millis_t duration) {
+            for (duration_millis_t t = 0; t < duration; t += 100) {
+                if (t % 1000 == 0) {
+                    slow.update();
+                }
+                fast.update();
+            }
+        };
+
+        THEN("Both pairs reach half of the step after about 9 seconds")
+        {
+            run(5000);
+            CHECK(slow.value() < temp_t(25));
+            CHECK(fast.value() < temp_t(25));
+
+            run(7000);
+            CHECK(slow.value() > temp_t(25));
+            CHECK(fast.value() > temp_t(25));
+        }
+    }
+
+    WHEN("The longest filter is chosen at a sample interval of 100ms")
+    {
+        slow.filterChoice(6);
+        fast.filterChoice(6);
+        CHECK(slow.filterLength() == 6);
+        CHECK(fast.filterLength() == 6);
+
+        sensor->setting(30);
+        duration_millis_t t = 0;
+        auto runUntil = [&](duration_millis_t end) {
+            for (; t < end; t += 100) {
+                if (t % 1000 == 0) {
+                    slow.update();
+                }
+                fast.update();
+            }
+        };
+
+        THEN("Both pairs reach half of the step after about 1400 seconds")
+        {
+            runUntil(1300'000);
+            CHECK(slow.value() < temp_t(25));
+            CHECK(fast.value() < temp_t(25));
+
+            runUntil(1500'000);
+            CHECK(slow.value() > temp_t(25));
+            CHECK(fast.value() > temp_t(25));
+        }
+    }
+}
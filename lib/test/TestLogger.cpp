@@ -43,7 +43,9 @@ TestLogger::add(std::string&& s)
 Logger&
 logger()
 {
-    static Logger logger([](Logger::LogLevel level, const std::string& log) {
+    // no clock is provided, so messages are not rate limited in tests
+    static Logger logger([](Logger::LogLevel level, const char* message, size_t length) {
+        std::string log(message, length);
         switch (level) {
         case Logger::LogLevel::DEBUG:
             TestLogger::add("LOG(DEBUG): " + log);